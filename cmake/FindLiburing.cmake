@@ -0,0 +1,7 @@
+find_package(PkgConfig QUIET)
+
+pkg_check_modules(Liburing liburing IMPORTED_TARGET)
+
+if (NOT TARGET PkgConfig::Liburing)
+    set(Liburing_FOUND 0)
+endif()
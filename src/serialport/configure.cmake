@@ -6,6 +6,7 @@
 
 #### Libraries
 
+qt_find_package(Liburing PROVIDED_TARGETS PkgConfig::Liburing MODULE_NAME serialport QMAKE_LIB liburing)
 
 
 #### Tests
@@ -38,6 +39,12 @@ qt_feature("ntddmodm" PRIVATE
     DISABLE INPUT_ntddmodm STREQUAL 'no'
 )
 qt_feature_definition("ntddmodm" "QT_NO_REDEFINE_GUID_DEVINTERFACE_MODEM" NEGATE)
+qt_feature("liburing" PRIVATE
+    LABEL "io_uring"
+    AUTODETECT OFF
+    CONDITION LINUX AND Liburing_FOUND
+)
 qt_configure_add_summary_section(NAME "Serial Port")
 qt_configure_add_summary_entry(ARGS "ntddmodm")
+qt_configure_add_summary_entry(ARGS "liburing")
 qt_configure_end_summary_section() # end of "Serial Port" section
@@ -45,8 +45,21 @@
 #include "qserialportinfo_p.h"
 
 #include "qserialport_p.h"
+#include "qserialportgroup_p.h"
 
+#include <QtCore/qalgorithms.h>
 #include <QtCore/qdebug.h>
+#include <QtCore/qvarlengtharray.h>
+#include <QtCore/private/qsimd_p.h>
+
+#include <qtserialport_tracepoints_p.h>
+
+#if defined(Q_PROCESSOR_ARM_64) && (defined(__ARM_NEON__) || defined(__ARM_NEON))
+#include <arm_neon.h>
+#define QT_SERIALPORT_FIND_BYTE_NEON
+#endif
+
+#include <string.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -95,6 +108,333 @@ QSerialPortPrivate::QSerialPortPrivate()
     readBufferChunkSize = QSERIALPORT_BUFFERSIZE;
 }
 
+// The native handle of the port as carried by the tracepoints.
+static inline qint64 traceDescriptor(const QSerialPortPrivate *d)
+{
+#if defined(Q_OS_WIN32)
+    return qint64(reinterpret_cast<qintptr>(d->handle));
+#else
+    return d->descriptor;
+#endif
+}
+
+// Bounds of the read chunk size used by the QSerialPort::AdaptiveReadChunk policy.
+static const qint64 minimumAdaptiveReadChunkSize = 64;
+static const qint64 maximumAdaptiveReadChunkSize = 1024 * 1024;
+
+qint64 QSerialPortPrivate::nextReadChunkSize()
+{
+    switch (readChunkPolicy) {
+    case QSerialPort::AvailableReadChunk: {
+        const qint64 queuedBytes = queuedBytesCount(QSerialPort::Input);
+        if (queuedBytes < 0)
+            return readChunkSize;
+        // Ask for at least one byte, a hang-up is reported as a zero-sized read.
+        return qMax(queuedBytes, qint64(1));
+    }
+    case QSerialPort::AdaptiveReadChunk:
+        adaptiveReadChunkSize = qMax(adaptiveReadChunkSize, adaptiveReadChunkFloor());
+        return adaptiveReadChunkSize;
+    default:
+        return readChunkSize;
+    }
+}
+
+qint64 QSerialPortPrivate::adaptiveReadChunkFloor() const
+{
+    // Assuming ten bits per character on the line, this is the amount of
+    // data which arrives in about ten milliseconds at the current speed.
+    const qint64 floor = qint64(inputBaudRate) / 1000;
+    return qBound(minimumAdaptiveReadChunkSize, floor, maximumAdaptiveReadChunkSize);
+}
+
+void QSerialPortPrivate::updateAdaptiveReadChunkSize(qint64 requestedBytes, qint64 readBytes)
+{
+    if (readBytes >= requestedBytes) {
+        // The burst did not fit, so more data is probably still queued.
+        adaptiveReadChunkSize = qMin(adaptiveReadChunkSize * 2, maximumAdaptiveReadChunkSize);
+    } else if (readBytes < adaptiveReadChunkSize / 4) {
+        adaptiveReadChunkSize = qMax(adaptiveReadChunkSize / 2, adaptiveReadChunkFloor());
+    }
+}
+
+#if defined(QT_BUILD_INTERNAL)
+bool qt_serialport_find_byte_avx2_disabled = false;
+#endif
+
+// The vector loops only look at whole vectors, they store the number of
+// bytes searched without a match in scanned.
+
+#if QT_COMPILER_SUPPORTS_HERE(AVX2)
+QT_FUNCTION_TARGET(AVX2)
+static qsizetype findByteAvx2(const char *data, qsizetype size, char byte, qsizetype *scanned)
+{
+    const __m256i needle = _mm256_set1_epi8(byte);
+    qsizetype i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        const uint mask = uint(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle)));
+        if (mask)
+            return i + qCountTrailingZeroBits(mask);
+    }
+    *scanned = i;
+    return -1;
+}
+#endif
+
+#if defined(__SSE2__)
+static qsizetype findByteSse2(const char *data, qsizetype size, char byte, qsizetype *scanned)
+{
+    const __m128i needle = _mm_set1_epi8(byte);
+    qsizetype i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        const uint mask = uint(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+        if (mask)
+            return i + qCountTrailingZeroBits(mask);
+    }
+    *scanned = i;
+    return -1;
+}
+#endif
+
+#if defined(QT_SERIALPORT_FIND_BYTE_NEON)
+static qsizetype findByteNeon(const char *data, qsizetype size, char byte, qsizetype *scanned)
+{
+    const uint8x16_t needle = vdupq_n_u8(uchar(byte));
+    qsizetype i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const uint8x16_t matches = vceqq_u8(vld1q_u8(reinterpret_cast<const uchar *>(data + i)), needle);
+        // Narrow every byte of the comparison to four bits of a 64-bit mask.
+        const quint64 mask = vget_lane_u64(vreinterpret_u64_u8(
+                vshrn_n_u16(vreinterpretq_u16_u8(matches), 4)), 0);
+        if (mask)
+            return i + qCountTrailingZeroBits(mask) / 4;
+    }
+    *scanned = i;
+    return -1;
+}
+#endif
+
+qsizetype qt_serialport_find_byte(const char *data, qsizetype size, char byte)
+{
+    qsizetype scanned = 0;
+    qsizetype index = -1;
+    bool vectorized = false;
+
+#if QT_COMPILER_SUPPORTS_HERE(AVX2)
+    bool useAvx2 = qCpuHasFeature(AVX2);
+#  if defined(QT_BUILD_INTERNAL)
+    useAvx2 = useAvx2 && !qt_serialport_find_byte_avx2_disabled;
+#  endif
+    if (useAvx2) {
+        index = findByteAvx2(data, size, byte, &scanned);
+        vectorized = true;
+    }
+#endif
+#if defined(__SSE2__)
+    if (!vectorized)
+        index = findByteSse2(data, size, byte, &scanned);
+#elif defined(QT_SERIALPORT_FIND_BYTE_NEON)
+    if (!vectorized)
+        index = findByteNeon(data, size, byte, &scanned);
+#endif
+    Q_UNUSED(vectorized);
+
+    if (index >= 0)
+        return index;
+
+    const void *match = ::memchr(data + scanned, uchar(byte), size_t(size - scanned));
+    return match ? static_cast<const char *>(match) - data : -1;
+}
+
+qint64 qt_serialport_find_delimiter(const QRingBufferRef &buffer, qint64 position,
+                                    const QByteArray &delimiter, qint64 *resumePosition)
+{
+    const qint64 available = buffer.size();
+    const qsizetype delimiterSize = delimiter.size();
+    const char firstByte = delimiter.at(0);
+    QVarLengthArray<char, 16> candidate(delimiterSize);
+
+    // Search the contiguous blocks of the ring buffer in place.
+    while (position < available) {
+        qint64 length = 0;
+        const char *data = buffer.readPointerAtPosition(position, length);
+        if (!data || length <= 0)
+            break;
+
+        const qsizetype index = qt_serialport_find_byte(data, length, firstByte);
+        if (index < 0) {
+            position += length;
+            continue;
+        }
+
+        position += index;
+        // A delimiter at the end may still be incomplete.
+        if (position + delimiterSize > available)
+            break;
+
+        if (delimiterSize == 1
+                || (buffer.peek(candidate.data(), delimiterSize, position) == delimiterSize
+                    && ::memcmp(candidate.constData(), delimiter.constData(),
+                                size_t(delimiterSize)) == 0)) {
+            return position;
+        }
+        ++position;
+    }
+
+    *resumePosition = position;
+    return -1;
+}
+
+qint64 QSerialPortPrivate::characterTimeNsecs() const
+{
+    // A character is framed by one start bit, an optional parity bit and
+    // the stop bits. Count half bits to cover QSerialPort::OneAndHalfStop.
+    qint64 halfBits = 2 * (1 + qint64(dataBits.value()));
+    if (parity.value() != QSerialPort::NoParity)
+        halfBits += 2;
+    switch (stopBits.value()) {
+    case QSerialPort::OneAndHalfStop:
+        halfBits += 3;
+        break;
+    case QSerialPort::TwoStop:
+        halfBits += 4;
+        break;
+    default:
+        halfBits += 2;
+        break;
+    }
+
+    const qint64 halfBitRate = 2 * qint64(qMax(inputBaudRate, 1));
+    return (halfBits * 1000000000 + halfBitRate - 1) / halfBitRate;
+}
+
+qint64 QSerialPortPrivate::frameIdleGapNsecs() const
+{
+    return qint64(frameIdleGap * characterTimeNsecs() + 0.5);
+}
+
+void QSerialPortPrivate::takeFrameData()
+{
+    const qint64 now = QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+
+    // Move everything received so far to the current frame, the frame is
+    // complete when nothing else arrives until the deadline.
+    const qint64 size = buffer.size();
+    if (size > 0) {
+        const qsizetype offset = frameBuffer.size();
+        if (offset == 0)
+            frameStartTime = now;
+        frameBuffer.resize(offset + size);
+        buffer.read(frameBuffer.data() + offset, size);
+    }
+
+    frameDeadline = now + frameIdleGapNsecs();
+    startFrameIdleTimer();
+}
+
+void QSerialPortPrivate::restoreFrameData()
+{
+    // The frame was received before anything left in the read buffer, so
+    // it goes back to the front. Its bytes were counted when they arrived.
+    const qint64 size = frameBuffer.size();
+    ::memcpy(buffer.reserveFront(size), frameBuffer.constData(), size);
+    frameBuffer.clear();
+
+    if (receiveTimestampingEnabled) {
+        // The entries up to the beginning of the frame are stale, the ones
+        // of later chunks within the frame still apply.
+        const qint64 offset = receivedByteCount - buffer.size();
+        qsizetype end = receiveTimestampHead;
+        while (end < receiveTimestamps.size() && receiveTimestamps.at(end).offset <= offset)
+            ++end;
+        receiveTimestamps.remove(receiveTimestampHead, end - receiveTimestampHead);
+        receiveTimestamps.insert(receiveTimestampHead, { offset, frameStartTime });
+    }
+}
+
+void QSerialPortPrivate::recordReceivedData(qint64 bytes)
+{
+    // Called right after the bytes have been appended to the read buffer.
+    if (bytes <= 0)
+        return;
+
+    if (receiveTimestampingEnabled) {
+        discardReceiveTimestamps();
+        receiveTimestamps.append({ receivedByteCount,
+                                   QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs() });
+    }
+    receivedByteCount += bytes;
+    statistics.recordReadBufferSize(buffer.size());
+}
+
+void QSerialPortPrivate::discardReceiveTimestamps()
+{
+    if (buffer.isEmpty()) {
+        receiveTimestamps.clear();
+        receiveTimestampHead = 0;
+        return;
+    }
+
+    // Keep the entry of the chunk in which the unread data begins.
+    const qint64 unreadOffset = receivedByteCount - buffer.size();
+    while (receiveTimestampHead + 1 < receiveTimestamps.size()
+           && receiveTimestamps.at(receiveTimestampHead + 1).offset <= unreadOffset) {
+        ++receiveTimestampHead;
+    }
+
+    if (receiveTimestampHead >= 64 && receiveTimestampHead * 2 >= receiveTimestamps.size()) {
+        receiveTimestamps.remove(0, receiveTimestampHead);
+        receiveTimestampHead = 0;
+    }
+}
+
+qint64 QSerialPortPrivate::findLineEnd(const QByteArray &terminator, LineScan *scan) const
+{
+    const qint64 available = buffer.size();
+
+    // Data is appended to the end of the read buffer and taken from its
+    // beginning, so the part which has not been searched yet is at the end.
+    qint64 position = 0;
+    if (scan->tail >= 0) {
+        const qint64 unsearched = scan->tail + (receivedByteCount - scan->receivedCount);
+        position = available - qMin(unsearched, available);
+    }
+
+    qint64 resumePosition = 0;
+    const qint64 terminatorPosition = qt_serialport_find_delimiter(buffer, position, terminator,
+                                                                   &resumePosition);
+    if (terminatorPosition >= 0) {
+        // Reading the line changes the beginning of the buffer, search it
+        // again from there.
+        scan->tail = -1;
+        return terminatorPosition;
+    }
+
+    scan->tail = available - resumePosition;
+    scan->receivedCount = receivedByteCount;
+    return -1;
+}
+
+void QSerialPortPrivate::frameIdleNotification()
+{
+    Q_Q(QSerialPort);
+
+    if (frameBuffer.isEmpty())
+        return;
+
+    // A coarse timer may fire early, so check against the deadline.
+    if (QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs() < frameDeadline) {
+        startFrameIdleTimer();
+        return;
+    }
+
+    QByteArray frame;
+    frame.swap(frameBuffer);
+    emit q->frameReceived(frame);
+}
+
 void QSerialPortPrivate::setError(const QSerialPortErrorInfo &errorInfo)
 {
     Q_Q(QSerialPort);
@@ -124,15 +464,25 @@ void QSerialPortPrivate::setError(const QSerialPortErrorInfo &errorInfo)
     After setting the port, you can open it in read-only (r/o), write-only
     (w/o), or read-write (r/w) mode using the open() method.
 
-    \note The serial port is always opened with exclusive access
+    \note The serial port is opened with exclusive access by default
     (that is, no other process or thread can access an already opened serial port).
+    On Unix, the way the port is locked can be changed with setLockingStrategy().
 
     Use the close() method to close the port and cancel the I/O operations.
 
     Having successfully opened, QSerialPort tries to determine the current
     configuration of the port and initializes itself. You can reconfigure the
     port to the desired setting using the setBaudRate(), setDataBits(),
-    setParity(), setStopBits(), and setFlowControl() methods.
+    setParity(), setStopBits(), and setFlowControl() methods, or change all
+    of these settings at once with applyConfiguration().
+
+    \note On Unix, QSerialPort keeps the settings it last passed to the driver
+    and does not read them back before each change. Settings that other
+    processes change on the open port are therefore overwritten by the next
+    change. Setting the \c QT_SERIALPORT_VERIFY_SETTINGS environment
+    variable before opening the port makes QSerialPort read the settings
+    back after each change instead, and report the ones that the driver did
+    not accept with the QSerialPort::UnsupportedOperationError error.
 
     There are a couple of properties to work with the pinout signals namely:
     QSerialPort::dataTerminalReady, QSerialPort::requestToSend. It is also
@@ -366,6 +716,93 @@ void QSerialPortPrivate::setError(const QSerialPortErrorInfo &errorInfo)
     \sa QSerialPort::error
 */
 
+/*!
+    \enum QSerialPort::ReadChunkPolicy
+    \since 6.2
+
+    This enum describes how many bytes QSerialPort asks the operating system
+    for each time incoming data is announced.
+
+    \value FixedReadChunk       The same amount of bytes, given by
+                                readChunkSize(), is requested every time.
+                                This is the default.
+    \value AvailableReadChunk   Exactly the amount of bytes queued in the
+                                driver is requested. This costs an additional
+                                query of the driver per read, but never
+                                reserves more memory than needed.
+    \value AdaptiveReadChunk    The amount of bytes requested is derived from
+                                the input baud rate and then grows or shrinks
+                                with the size of the bursts actually received.
+
+    \sa setReadChunkPolicy(), setReadChunkSize()
+*/
+
+/*!
+    \enum QSerialPort::WritePolicy
+    \since 6.2
+
+    This enum describes when data passed to write() is handed over to the
+    operating system.
+
+    \value DeferredWrite        The data is buffered and sent once control
+                                returns to the event loop. This is the
+                                default.
+    \value ImmediateWrite       If no data is waiting in the write buffer, a
+                                non-blocking write is attempted right away
+                                from within write(). Whatever cannot be sent
+                                is buffered as with DeferredWrite. This
+                                minimizes the latency of short commands.
+    \value CoalescedWrite       The data is held back until the write buffer
+                                reaches writeCoalescingByteLimit() bytes or
+                                writeCoalescingTimeLimit() microseconds have
+                                passed since the first write, so that many
+                                small writes are sent together.
+
+    \sa setWritePolicy()
+*/
+
+/*!
+    \enum QSerialPort::LowLatencyFeature
+    \since 6.2
+
+    This enum describes the driver settings changed by the low latency mode.
+
+    \value NoLowLatencyFeature      No setting has been changed.
+    \value AsyncLowLatencyFeature   The ASYNC_LOW_LATENCY flag of the serial
+                                    driver is set, so that received data is
+                                    pushed to the application without delay.
+    \value LatencyTimerFeature      The latency timer of a USB to serial
+                                    converter, such as FTDI devices have, is
+                                    set to its minimum of one millisecond.
+
+    \sa setLowLatencyMode(), lowLatencyFeatures()
+*/
+
+/*!
+    \enum QSerialPort::LockingStrategy
+    \since 6.2
+
+    This enum describes how a port is protected against being opened by
+    other processes on Unix.
+
+    \value LockFileLocking          A UUCP lock file is created in one of the
+                                    system lock directories, such as
+                                    \c{/var/lock}, and the terminal is put
+                                    into exclusive mode. This is the default.
+    \value DescriptorLocking        An exclusive \c flock() lock is taken on
+                                    the opened device, and the terminal is
+                                    put into exclusive mode. This needs no
+                                    writable lock directory, but only
+                                    protects against processes that take
+                                    the same lock.
+    \value ExclusiveModeLocking     The terminal is only put into exclusive
+                                    mode, so that other processes without
+                                    superuser privileges cannot open it.
+    \value NoLocking                The port is not locked at all.
+
+    \sa setLockingStrategy()
+*/
+
 
 
 /*!
@@ -407,6 +844,12 @@ QSerialPort::~QSerialPort()
     /**/
     if (isOpen())
         close();
+
+#if defined(Q_OS_UNIX)
+    Q_D(QSerialPort);
+    if (d->group)
+        d->group->detachPort(d);
+#endif
 }
 
 /*!
@@ -494,9 +937,13 @@ bool QSerialPort::open(OpenMode mode)
     }
 
     clearError();
-    if (!d->open(mode))
+    Q_TRACE(QSerialPort_open_entry, d->systemLocation, int(mode));
+    if (!d->open(mode)) {
+        Q_TRACE(QSerialPort_open_exit, -1, false);
         return false;
+    }
 
+    Q_TRACE(QSerialPort_open_exit, traceDescriptor(d), true);
     QIODevice::open(mode);
     return true;
 }
@@ -517,8 +964,11 @@ void QSerialPort::close()
         return;
     }
 
+    Q_TRACE(QSerialPort_close, traceDescriptor(d));
     d->close();
     d->isBreakEnabled.setValue(false);
+    d->receiveTimestamps.clear();
+    d->receiveTimestampHead = 0;
     QIODevice::close();
 }
 
@@ -790,6 +1240,207 @@ QBindable<QSerialPort::FlowControl> QSerialPort::bindableFlowControl()
     \sa QSerialPort::flowControl
 */
 
+/*!
+    \class QSerialPort::Configuration
+    \inmodule QtSerialPort
+    \since 6.2
+
+    \brief The Configuration struct holds the line settings of a serial port.
+
+    The default values match the defaults of the corresponding properties.
+
+    \sa configuration(), applyConfiguration()
+*/
+
+/*!
+    \variable QSerialPort::Configuration::inputBaudRate
+
+    The baud rate for the Input direction.
+*/
+
+/*!
+    \variable QSerialPort::Configuration::outputBaudRate
+
+    The baud rate for the Output direction.
+*/
+
+/*!
+    \variable QSerialPort::Configuration::dataBits
+
+    The data bits in a frame.
+*/
+
+/*!
+    \variable QSerialPort::Configuration::parity
+
+    The parity checking mode.
+*/
+
+/*!
+    \variable QSerialPort::Configuration::stopBits
+
+    The number of stop bits in a frame.
+*/
+
+/*!
+    \variable QSerialPort::Configuration::flowControl
+
+    The flow control mode.
+*/
+
+/*!
+    \since 6.2
+
+    Returns the current line settings of the serial port.
+
+    \sa applyConfiguration()
+*/
+QSerialPort::Configuration QSerialPort::configuration() const
+{
+    Q_D(const QSerialPort);
+    Configuration configuration;
+    configuration.inputBaudRate = d->inputBaudRate;
+    configuration.outputBaudRate = d->outputBaudRate;
+    configuration.dataBits = d->dataBits;
+    configuration.parity = d->parity;
+    configuration.stopBits = d->stopBits;
+    configuration.flowControl = d->flowControl;
+    return configuration;
+}
+
+static bool isValidConfiguration(const QSerialPort::Configuration &configuration,
+                                 QString *errorString)
+{
+    if (configuration.inputBaudRate <= 0 || configuration.outputBaudRate <= 0) {
+        *errorString = QSerialPort::tr("Invalid baud rate value");
+        return false;
+    }
+
+    switch (configuration.dataBits) {
+    case QSerialPort::Data5:
+    case QSerialPort::Data6:
+    case QSerialPort::Data7:
+    case QSerialPort::Data8:
+        break;
+    default:
+        *errorString = QSerialPort::tr("Invalid data bits value");
+        return false;
+    }
+
+    switch (configuration.parity) {
+    case QSerialPort::NoParity:
+    case QSerialPort::EvenParity:
+    case QSerialPort::OddParity:
+    case QSerialPort::SpaceParity:
+    case QSerialPort::MarkParity:
+        break;
+    default:
+        *errorString = QSerialPort::tr("Invalid parity value");
+        return false;
+    }
+
+    switch (configuration.stopBits) {
+    case QSerialPort::OneStop:
+    case QSerialPort::OneAndHalfStop:
+    case QSerialPort::TwoStop:
+        break;
+    default:
+        *errorString = QSerialPort::tr("Invalid stop bits value");
+        return false;
+    }
+
+    switch (configuration.flowControl) {
+    case QSerialPort::NoFlowControl:
+    case QSerialPort::HardwareControl:
+    case QSerialPort::SoftwareControl:
+        break;
+    default:
+        *errorString = QSerialPort::tr("Invalid flow control value");
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+    \since 6.2
+
+    Applies all line settings in \a configuration at once.
+
+    Unlike a sequence of calls to setBaudRate(), setDataBits(), setParity(),
+    setStopBits() and setFlowControl(), this validates the whole
+    configuration first and then commits it to an open port in a single
+    request to the driver, so that the line never passes through a mix of
+    the old and the new settings. On Linux, this holds for custom baud
+    rates as well.
+
+    If the port is not open, the settings are stored and applied by open().
+
+    Once the settings are committed, the baudRate, dataBits, parity,
+    stopBits and flowControl properties are updated, and the corresponding
+    change signals are emitted for the properties that changed.
+
+    Returns \c true on success; otherwise returns \c false, leaves the
+    settings unchanged and sets an error code which can be obtained by
+    accessing the value of the QSerialPort::error property.
+
+    \sa configuration()
+*/
+bool QSerialPort::applyConfiguration(const Configuration &configuration)
+{
+    Q_D(QSerialPort);
+
+    QString errorString;
+    if (!isValidConfiguration(configuration, &errorString)) {
+        d->setError(QSerialPortErrorInfo(QSerialPort::UnsupportedOperationError, errorString));
+        return false;
+    }
+
+    if (isOpen() && !d->applyConfiguration(configuration))
+        return false;
+
+    Directions baudRateDirections;
+    if (d->inputBaudRate != configuration.inputBaudRate) {
+        d->inputBaudRate = configuration.inputBaudRate;
+        baudRateDirections |= QSerialPort::Input;
+    }
+    if (d->outputBaudRate != configuration.outputBaudRate) {
+        d->outputBaudRate = configuration.outputBaudRate;
+        baudRateDirections |= QSerialPort::Output;
+    }
+
+    const auto currentDataBits = d->dataBits.value();
+    const auto currentParity = d->parity.value();
+    const auto currentStopBits = d->stopBits.value();
+    const auto currentFlowControl = d->flowControl.value();
+    d->dataBits.setValue(configuration.dataBits);
+    d->parity.setValue(configuration.parity);
+    d->stopBits.setValue(configuration.stopBits);
+    d->flowControl.setValue(configuration.flowControl);
+
+    // The signals are emitted once all settings are updated, so that the
+    // receivers see the new configuration as a whole.
+    if (baudRateDirections == QSerialPort::AllDirections
+            && configuration.inputBaudRate == configuration.outputBaudRate) {
+        emit baudRateChanged(configuration.outputBaudRate, QSerialPort::AllDirections);
+    } else {
+        if (baudRateDirections & QSerialPort::Input)
+            emit baudRateChanged(configuration.inputBaudRate, QSerialPort::Input);
+        if (baudRateDirections & QSerialPort::Output)
+            emit baudRateChanged(configuration.outputBaudRate, QSerialPort::Output);
+    }
+    if (currentDataBits != configuration.dataBits)
+        emit dataBitsChanged(configuration.dataBits);
+    if (currentParity != configuration.parity)
+        emit parityChanged(configuration.parity);
+    if (currentStopBits != configuration.stopBits)
+        emit stopBitsChanged(configuration.stopBits);
+    if (currentFlowControl != configuration.flowControl)
+        emit flowControlChanged(configuration.flowControl);
+
+    return true;
+}
+
 /*!
     \property QSerialPort::dataTerminalReady
     \brief the state (high or low) of the line signal DTR
@@ -1057,56 +1708,1057 @@ void QSerialPort::setReadBufferSize(qint64 size)
 }
 
 /*!
-    \reimp
+    \since 6.2
 
-    Always returns \c true. The serial port is a sequential device.
+    Returns the policy used to size the reads from the serial port.
+
+    \sa setReadChunkPolicy(), readChunkSize()
 */
-bool QSerialPort::isSequential() const
+QSerialPort::ReadChunkPolicy QSerialPort::readChunkPolicy() const
 {
-    return true;
+    Q_D(const QSerialPort);
+    return d->readChunkPolicy;
 }
 
 /*!
-    \reimp
+    \since 6.2
 
-    Returns the number of incoming bytes that are waiting to be read.
+    Sets the policy used to size the reads from the serial port to \a policy.
 
-    \sa bytesToWrite(), read()
+    Slow ports rarely deliver more than a few bytes at a time, so a small
+    or an adaptive chunk avoids reserving memory in the read buffer which
+    is never used. Fast ports benefit from larger chunks, as fewer calls
+    to the operating system are needed to move the same amount of data.
+
+    The default policy is FixedReadChunk.
+
+    \sa readChunkPolicy(), setReadChunkSize()
 */
-qint64 QSerialPort::bytesAvailable() const
+void QSerialPort::setReadChunkPolicy(ReadChunkPolicy policy)
 {
-    return QIODevice::bytesAvailable();
+    Q_D(QSerialPort);
+    d->readChunkPolicy = policy;
+    d->adaptiveReadChunkSize = 0;
 }
 
 /*!
-    \reimp
+    \since 6.2
 
-    Returns the number of bytes that are waiting to be written. The
-    bytes are written when control goes back to the event loop or
-    when flush() is called.
+    Returns the number of bytes requested per read when the read chunk
+    policy is FixedReadChunk.
 
-    \sa bytesAvailable(), flush()
+    \sa setReadChunkSize(), readChunkPolicy()
 */
-qint64 QSerialPort::bytesToWrite() const
+qint64 QSerialPort::readChunkSize() const
 {
-    qint64 pendingBytes = QIODevice::bytesToWrite();
-#if defined(Q_OS_WIN32)
-    pendingBytes += d_func()->writeChunkBuffer.size();
-#endif
-    return pendingBytes;
+    Q_D(const QSerialPort);
+    return d->readChunkSize;
 }
 
 /*!
-    \reimp
+    \since 6.2
 
-    Returns \c true if a line of data can be read from the serial port;
-    otherwise returns \c false.
+    Sets the number of bytes requested per read when the read chunk policy
+    is FixedReadChunk to \a size. This size is also used by the
+    AvailableReadChunk policy when the driver cannot report the number of
+    queued bytes.
 
-    \sa readLine()
+    The \a size has to be positive. The default value is 32768 bytes.
+
+    \sa readChunkSize(), setReadChunkPolicy()
 */
-bool QSerialPort::canReadLine() const
+void QSerialPort::setReadChunkSize(qint64 size)
 {
-    return QIODevice::canReadLine();
+    Q_D(QSerialPort);
+
+    if (size <= 0) {
+        qWarning("%s: invalid read chunk size %lld", Q_FUNC_INFO, size);
+        return;
+    }
+
+    d->readChunkSize = size;
+}
+
+/*!
+    \since 6.2
+
+    Returns \c true if batched reading is enabled; otherwise returns \c false.
+
+    \sa setReadBatchingEnabled()
+*/
+bool QSerialPort::isReadBatchingEnabled() const
+{
+    Q_D(const QSerialPort);
+    return d->readBatchingEnabled;
+}
+
+/*!
+    \since 6.2
+
+    Enables batched reading if \a enable is \c true; otherwise disables it.
+
+    By default, each notification about incoming data results in one read
+    from the serial port and one \l{QIODevice::}{readyRead()} signal. With
+    batched reading enabled, QSerialPort keeps reading until no more data is
+    queued in the driver, or until the limits set by setReadBatchByteLimit()
+    and setReadBatchTimeLimit() are reached, and then emits readyRead() only
+    once for the whole batch. At high baud rates this saves many round trips
+    through the event loop.
+
+    readBatchCount() and batchedReadCount() tell how much coalescing happened.
+
+    \note Batched reading is only supported on Unix.
+
+    \sa isReadBatchingEnabled()
+*/
+void QSerialPort::setReadBatchingEnabled(bool enable)
+{
+    Q_D(QSerialPort);
+    d->readBatchingEnabled = enable;
+}
+
+/*!
+    \since 6.2
+
+    Returns the maximum number of bytes read in one batch.
+
+    \sa setReadBatchByteLimit()
+*/
+qint64 QSerialPort::readBatchByteLimit() const
+{
+    Q_D(const QSerialPort);
+    return d->readBatchByteLimit;
+}
+
+/*!
+    \since 6.2
+
+    Sets the maximum number of bytes read in one batch to \a size. No more
+    reads are started once a batch has reached this size. A \a size of \c 0
+    means that batches are not limited in size.
+
+    The default value is 1048576 bytes.
+
+    \sa setReadBatchingEnabled(), setReadBatchTimeLimit()
+*/
+void QSerialPort::setReadBatchByteLimit(qint64 size)
+{
+    Q_D(QSerialPort);
+    d->readBatchByteLimit = qMax(size, qint64(0));
+}
+
+/*!
+    \since 6.2
+
+    Returns the maximum time spent reading one batch, in microseconds.
+
+    \sa setReadBatchTimeLimit()
+*/
+int QSerialPort::readBatchTimeLimit() const
+{
+    Q_D(const QSerialPort);
+    return d->readBatchTimeLimit;
+}
+
+/*!
+    \since 6.2
+
+    Sets the maximum time spent reading one batch to \a usecs microseconds.
+    No more reads are started once this time has elapsed since the beginning
+    of the batch. A value of \c 0 means that batches are not limited in time.
+
+    The default value is 1000 microseconds.
+
+    \sa setReadBatchingEnabled(), setReadBatchByteLimit()
+*/
+void QSerialPort::setReadBatchTimeLimit(int usecs)
+{
+    Q_D(QSerialPort);
+    d->readBatchTimeLimit = qMax(usecs, 0);
+}
+
+/*!
+    \since 6.2
+
+    Returns the number of batches read since the port was constructed or
+    resetReadBatchCounters() was called. Each batch results in at most one
+    \l{QIODevice::}{readyRead()} signal.
+
+    \sa batchedReadCount(), setReadBatchingEnabled()
+*/
+qint64 QSerialPort::readBatchCount() const
+{
+    Q_D(const QSerialPort);
+    return d->readBatchCount;
+}
+
+/*!
+    \since 6.2
+
+    Returns the number of reads from the serial port performed as part of a
+    batch since the port was constructed or resetReadBatchCounters() was
+    called. This includes the final read of each batch which finds no more
+    data queued.
+
+    \sa readBatchCount(), setReadBatchingEnabled()
+*/
+qint64 QSerialPort::batchedReadCount() const
+{
+    Q_D(const QSerialPort);
+    return d->batchedReadCount;
+}
+
+/*!
+    \since 6.2
+
+    Resets the values returned by readBatchCount() and batchedReadCount()
+    to \c 0.
+*/
+void QSerialPort::resetReadBatchCounters()
+{
+    Q_D(QSerialPort);
+    d->readBatchCount = 0;
+    d->batchedReadCount = 0;
+}
+
+/*!
+    \since 6.2
+
+    Returns \c true if the port is read by a dedicated thread; otherwise
+    returns \c false.
+
+    \sa setReadThreadEnabled()
+*/
+bool QSerialPort::isReadThreadEnabled() const
+{
+    Q_D(const QSerialPort);
+    return d->readThreadEnabled;
+}
+
+/*!
+    \since 6.2
+
+    Enables reading the port in a dedicated thread if \a enable is \c true;
+    otherwise the port is read by the event loop of the thread QSerialPort
+    lives in, which is the default.
+
+    In this mode, an internal thread reads incoming data as soon as it
+    arrives and stores it in a lock-free buffer of readThreadBufferSize()
+    bytes. The data is moved to the read buffer, and the
+    \l{QIODevice::}{readyRead()} signal is emitted, by the thread
+    QSerialPort lives in. Notifications are coalesced: however many reads
+    happened in between, readyRead() is emitted once per pass of the event
+    loop. This keeps the driver buffers from overflowing at high baud rates
+    while the owning thread is busy.
+
+    The setting takes effect when the port is opened for reading.
+
+    \note Reading in a dedicated thread is only supported on Unix.
+
+    \sa isReadThreadEnabled(), setReadThreadBufferSize()
+*/
+void QSerialPort::setReadThreadEnabled(bool enable)
+{
+    Q_D(QSerialPort);
+    d->readThreadEnabled = enable;
+}
+
+/*!
+    \since 6.2
+
+    Returns the size of the buffer filled by the read thread.
+
+    \sa setReadThreadBufferSize(), setReadThreadEnabled()
+*/
+qint64 QSerialPort::readThreadBufferSize() const
+{
+    Q_D(const QSerialPort);
+    return d->readThreadBufferSize;
+}
+
+/*!
+    \since 6.2
+
+    Sets the size of the buffer filled by the read thread to \a size bytes.
+    The size is rounded up to a power of two, with a minimum of 4096 bytes.
+    When the buffer is full, for example because the read buffer size is
+    limited, the read thread waits for the data to be consumed.
+
+    The default size is 1 megabyte. The setting takes effect when the port
+    is opened.
+
+    \sa readThreadBufferSize(), setReadThreadEnabled(), setReadBufferSize()
+*/
+void QSerialPort::setReadThreadBufferSize(qint64 size)
+{
+    Q_D(QSerialPort);
+    d->readThreadBufferSize = qMax(size, qint64(0));
+}
+
+/*!
+    \since 6.2
+
+    Returns the policy used to send written data to the serial port.
+
+    \sa setWritePolicy()
+*/
+QSerialPort::WritePolicy QSerialPort::writePolicy() const
+{
+    Q_D(const QSerialPort);
+    return d->writePolicy;
+}
+
+/*!
+    \since 6.2
+
+    Sets the policy used to send written data to the serial port to
+    \a policy.
+
+    In all cases, the \l{QIODevice::}{bytesWritten()} signal is emitted
+    from the event loop or from waitForBytesWritten(), never from within
+    write().
+
+    The default policy is DeferredWrite.
+
+    \sa writePolicy(), setWriteCoalescingByteLimit(),
+    setWriteCoalescingTimeLimit()
+*/
+void QSerialPort::setWritePolicy(WritePolicy policy)
+{
+    Q_D(QSerialPort);
+    d->writePolicy = policy;
+}
+
+/*!
+    \since 6.2
+
+    Returns the amount of buffered data which ends write coalescing.
+
+    \sa setWriteCoalescingByteLimit()
+*/
+qint64 QSerialPort::writeCoalescingByteLimit() const
+{
+    Q_D(const QSerialPort);
+    return d->writeCoalescingByteLimit;
+}
+
+/*!
+    \since 6.2
+
+    With the CoalescedWrite policy, buffered data is sent as soon as at
+    least \a size bytes are waiting in the write buffer.
+
+    The default value is 4096 bytes.
+
+    \sa setWritePolicy(), setWriteCoalescingTimeLimit()
+*/
+void QSerialPort::setWriteCoalescingByteLimit(qint64 size)
+{
+    Q_D(QSerialPort);
+    d->writeCoalescingByteLimit = qMax(size, qint64(0));
+}
+
+/*!
+    \since 6.2
+
+    Returns the maximum time, in microseconds, for which data is held back
+    by write coalescing.
+
+    \sa setWriteCoalescingTimeLimit()
+*/
+int QSerialPort::writeCoalescingTimeLimit() const
+{
+    Q_D(const QSerialPort);
+    return d->writeCoalescingTimeLimit;
+}
+
+/*!
+    \since 6.2
+
+    With the CoalescedWrite policy, buffered data is sent at the latest
+    \a usecs microseconds after it was written.
+
+    \note The time limit is rounded up to whole milliseconds, the
+    resolution of the timers of the event loop.
+
+    The default value is 1000 microseconds.
+
+    \sa setWritePolicy(), setWriteCoalescingByteLimit()
+*/
+void QSerialPort::setWriteCoalescingTimeLimit(int usecs)
+{
+    Q_D(QSerialPort);
+    d->writeCoalescingTimeLimit = qMax(usecs, 0);
+}
+
+/*!
+    \since 6.2
+
+    Returns the strategy used to lock the port when it is opened.
+
+    \sa setLockingStrategy()
+*/
+QSerialPort::LockingStrategy QSerialPort::lockingStrategy() const
+{
+    Q_D(const QSerialPort);
+    return d->lockingStrategy;
+}
+
+/*!
+    \since 6.2
+
+    Sets the strategy used to lock the port when it is opened to
+    \a strategy. The default is LockFileLocking.
+
+    LockFileLocking interoperates with other programs that use UUCP lock
+    files, but costs a file system write and a check for a stale lock on
+    every open(), and fails if none of the lock directories is writable,
+    as in many containers. The other strategies avoid the lock file.
+
+    The setting takes effect when the port is opened.
+
+    \note On Windows, the port is always opened with exclusive access and
+    the setting has no effect.
+
+    \sa lockingStrategy()
+*/
+void QSerialPort::setLockingStrategy(LockingStrategy strategy)
+{
+    Q_D(QSerialPort);
+    d->lockingStrategy = strategy;
+}
+
+/*!
+    \since 6.2
+
+    Enables the low latency mode if \a enable is \c true; otherwise
+    disables it.
+
+    In low latency mode, QSerialPort asks the driver to deliver received
+    data as soon as possible instead of collecting it first. Which settings
+    could actually be changed is returned by lowLatencyFeatures(). The
+    previous driver settings are restored when the port is closed, unless
+    the settings are not restored on close at all.
+
+    If the port is not open, the mode is applied when the port is opened
+    and \c true is returned. If the port is open and none of the settings
+    could be changed, returns \c false and sets the
+    UnsupportedOperationError error code.
+
+    \note The low latency mode is only supported on Linux. Changing the
+    latency timer of USB to serial converters usually requires write access
+    to sysfs.
+
+    \sa isLowLatencyMode(), lowLatencyFeatures()
+*/
+bool QSerialPort::setLowLatencyMode(bool enable)
+{
+    Q_D(QSerialPort);
+
+    d->lowLatencyMode = enable;
+    if (!isOpen())
+        return true;
+
+    if (!enable) {
+        d->restoreLowLatencyMode();
+        return true;
+    }
+
+    if (!d->applyLowLatencyMode()) {
+        d->setError(QSerialPortErrorInfo(QSerialPort::UnsupportedOperationError,
+                                         tr("Low latency mode is not supported by the device")));
+        return false;
+    }
+    return true;
+}
+
+/*!
+    \since 6.2
+
+    Returns \c true if the low latency mode is enabled; otherwise returns
+    \c false.
+
+    \sa setLowLatencyMode()
+*/
+bool QSerialPort::isLowLatencyMode() const
+{
+    Q_D(const QSerialPort);
+    return d->lowLatencyMode;
+}
+
+/*!
+    \since 6.2
+
+    Returns the driver settings which the low latency mode has changed on
+    the open port.
+
+    \sa setLowLatencyMode()
+*/
+QSerialPort::LowLatencyFeatures QSerialPort::lowLatencyFeatures() const
+{
+    Q_D(const QSerialPort);
+    return d->lowLatencyFeatures;
+}
+
+/*!
+    \since 6.2
+
+    Returns the idle gap which ends a frame, in character times.
+
+    \sa setFrameIdleGap(), frameReceived()
+*/
+double QSerialPort::frameIdleGap() const
+{
+    Q_D(const QSerialPort);
+    return d->frameIdleGap;
+}
+
+/*!
+    \since 6.2
+
+    Enables framing by line silence, with frames separated by an idle gap
+    of at least \a characterTimes character times. A value of \c 0
+    disables the framing; this is the default.
+
+    The duration of one character is computed from the current baud rate,
+    data bits, parity and stop bits; a start bit is always assumed. For
+    example, protocols like Modbus RTU use a gap of \c 3.5 characters.
+
+    While the framing is enabled, received data is not stored in the read
+    buffer and the \l{QIODevice::}{readyRead()} signal is not emitted.
+    Instead, the frameReceived() signal delivers the data once the line has
+    been idle for the given gap. When the framing is disabled, the data of
+    an incomplete frame is moved to the read buffer, keeping its receive
+    timestamp, and \l{QIODevice::}{readyRead()} is emitted for it once
+    control returns to the event loop.
+
+    \note Frames are detected by the event loop, so the blocking
+    waitForReadyRead() function cannot be used together with the framing.
+    On Linux, the gap is measured with a high resolution timer; on other
+    platforms, it is rounded up to full milliseconds.
+
+    \sa frameIdleGap(), frameReceived()
+*/
+void QSerialPort::setFrameIdleGap(double characterTimes)
+{
+    Q_D(QSerialPort);
+
+    d->frameIdleGap = qMax(characterTimes, 0.0);
+    if (d->frameIdleGap > 0 || d->frameBuffer.isEmpty())
+        return;
+
+    d->stopFrameIdleTimer();
+    const qint64 size = d->frameBuffer.size();
+    d->restoreFrameData();
+
+    // The data is announced from the event loop, as if it had just been
+    // read, unless the framing has been enabled again meanwhile.
+    QMetaObject::invokeMethod(this, [d, size]() {
+        if (!d->q_func()->isOpen())
+            return;
+#if defined(Q_OS_WIN32)
+        if (d->frameIdleGap > 0)
+            d->takeFrameData();
+        else
+            d->emitReadyRead();
+#else
+        d->deliverReadData(size);
+#endif
+    }, Qt::QueuedConnection);
+}
+
+/*!
+    \fn void QSerialPort::frameReceived(const QByteArray &frame)
+    \since 6.2
+
+    This signal is emitted when the line has been idle for the gap set with
+    setFrameIdleGap() after receiving data. The specified \a frame holds
+    all the data received since the previous frame.
+
+    \sa setFrameIdleGap()
+*/
+
+/*!
+    \class QSerialPort::ReceiveTimestamp
+    \inmodule QtSerialPort
+    \since 6.2
+
+    \brief The ReceiveTimestamp struct holds the arrival time of a chunk of
+    received data.
+
+    \sa readWithTimestamps()
+*/
+
+/*!
+    \variable QSerialPort::ReceiveTimestamp::offset
+
+    The offset of the chunk in the data returned by readWithTimestamps().
+*/
+
+/*!
+    \variable QSerialPort::ReceiveTimestamp::timestamp
+
+    The time at which the chunk was read from the driver, in nanoseconds
+    of the clock used by QDeadlineTimer with Qt::PreciseTimer. On Linux,
+    this is \c CLOCK_MONOTONIC.
+*/
+
+/*!
+    \since 6.2
+
+    Returns \c true if the arrival times of received data are recorded;
+    otherwise returns \c false.
+
+    \sa setReceiveTimestampingEnabled(), readWithTimestamps()
+*/
+bool QSerialPort::isReceiveTimestampingEnabled() const
+{
+    Q_D(const QSerialPort);
+    return d->receiveTimestampingEnabled;
+}
+
+/*!
+    \since 6.2
+
+    Enables recording the arrival times of received data if \a enable is
+    \c true. The default is \c false.
+
+    While enabled, the time of every chunk read from the driver is recorded
+    alongside the read buffer, one entry per chunk rather than per byte.
+    Use readWithTimestamps() to read the data together with the times.
+    Data received before the recording was enabled has no timestamps.
+
+    \note With the read thread enabled, the time at which the data is taken
+    over from the read thread is recorded.
+
+    \sa isReceiveTimestampingEnabled(), readWithTimestamps(),
+    setReadThreadEnabled()
+*/
+void QSerialPort::setReceiveTimestampingEnabled(bool enable)
+{
+    Q_D(QSerialPort);
+
+    if (d->receiveTimestampingEnabled == enable)
+        return;
+
+    d->receiveTimestampingEnabled = enable;
+    d->receiveTimestamps.clear();
+    d->receiveTimestampHead = 0;
+}
+
+/*!
+    \since 6.2
+
+    Reads at most \a maxSize bytes from the read buffer, or all of them if
+    \a maxSize is negative, and returns them. The arrival times of the
+    chunks in the returned data are stored in \a timestamps, in order. The
+    first entry covers the beginning of the data even if part of its chunk
+    has been read before; each entry lasts until the offset of the next
+    one.
+
+    Receive timestamping has to be enabled with
+    setReceiveTimestampingEnabled(); otherwise \a timestamps is empty.
+
+    \code
+    QList<QSerialPort::ReceiveTimestamp> timestamps;
+    const QByteArray data = serial.readWithTimestamps(&timestamps);
+    for (const QSerialPort::ReceiveTimestamp &chunk : timestamps)
+        fusion.addSample(data.mid(chunk.offset), chunk.timestamp);
+    \endcode
+
+    \sa setReceiveTimestampingEnabled(), QIODevice::read()
+*/
+QByteArray QSerialPort::readWithTimestamps(QList<ReceiveTimestamp> *timestamps, qint64 maxSize)
+{
+    Q_D(QSerialPort);
+
+    if (timestamps)
+        timestamps->clear();
+
+    const qint64 startOffset = d->receivedByteCount - d->buffer.size();
+    const QByteArray data = maxSize < 0 ? readAll() : read(maxSize);
+
+    if (timestamps && d->receiveTimestampingEnabled) {
+        const qint64 endOffset = startOffset + data.size();
+        const qsizetype count = d->receiveTimestamps.size();
+        for (qsizetype i = d->receiveTimestampHead; i < count; ++i) {
+            const ReceiveTimestamp &entry = d->receiveTimestamps.at(i);
+            if (entry.offset >= endOffset)
+                break;
+            const qint64 nextOffset = i + 1 < count
+                    ? d->receiveTimestamps.at(i + 1).offset : d->receivedByteCount;
+            if (nextOffset <= startOffset)
+                continue;
+            timestamps->append({ qMax(entry.offset - startOffset, qint64(0)), entry.timestamp });
+        }
+    }
+
+    d->discardReceiveTimestamps();
+    return data;
+}
+
+/*!
+    \class QSerialPort::Statistics
+    \inmodule QtSerialPort
+    \since 6.2
+
+    \brief The Statistics struct holds a snapshot of the I/O counters of a
+    serial port.
+
+    A read or write call is a single transfer between the driver and the
+    buffers of QSerialPort, such as a \c read() or \c writev() system call
+    on Unix or a completed overlapped operation on Windows. Only calls that
+    transferred data count as read or write calls; reads that returned
+    nothing are counted separately in emptyReadCalls.
+
+    \sa statistics()
+*/
+
+/*!
+    \variable QSerialPort::Statistics::readCalls
+
+    The number of read calls that returned data.
+*/
+
+/*!
+    \variable QSerialPort::Statistics::emptyReadCalls
+
+    The number of read calls that returned no data, for example because
+    the port was reported readable while the driver had nothing to read.
+*/
+
+/*!
+    \variable QSerialPort::Statistics::bytesRead
+
+    The number of bytes read from the driver.
+*/
+
+/*!
+    \variable QSerialPort::Statistics::minimumBytesPerRead
+
+    The smallest number of bytes returned by a read call, or 0 if there
+    were none.
+*/
+
+/*!
+    \variable QSerialPort::Statistics::maximumBytesPerRead
+
+    The largest number of bytes returned by a read call.
+*/
+
+/*!
+    \variable QSerialPort::Statistics::writeCalls
+
+    The number of write calls that passed data to the driver.
+*/
+
+/*!
+    \variable QSerialPort::Statistics::bytesWritten
+
+    The number of bytes passed to the driver.
+*/
+
+/*!
+    \variable QSerialPort::Statistics::minimumBytesPerWrite
+
+    The smallest number of bytes accepted by a write call, or 0 if there
+    were none.
+*/
+
+/*!
+    \variable QSerialPort::Statistics::maximumBytesPerWrite
+
+    The largest number of bytes accepted by a write call.
+*/
+
+/*!
+    \variable QSerialPort::Statistics::readyReadSignals
+
+    The number of times the \l{QIODevice::}{readyRead()} signal was emitted.
+*/
+
+/*!
+    \variable QSerialPort::Statistics::bytesWrittenSignals
+
+    The number of times the \l{QIODevice::}{bytesWritten()} signal was
+    emitted.
+*/
+
+/*!
+    \variable QSerialPort::Statistics::readBufferHighWaterMark
+
+    The largest number of bytes held in the read buffer.
+*/
+
+/*!
+    \variable QSerialPort::Statistics::writeBufferHighWaterMark
+
+    The largest number of bytes waiting to be written.
+*/
+
+/*!
+    \fn double QSerialPort::Statistics::averageBytesPerRead() const
+
+    Returns the average number of bytes returned by a read call.
+*/
+
+/*!
+    \fn double QSerialPort::Statistics::averageBytesPerWrite() const
+
+    Returns the average number of bytes accepted by a write call.
+*/
+
+/*!
+    \since 6.2
+
+    Returns a snapshot of the I/O counters of the serial port.
+
+    The counters are always maintained, with a few relaxed atomic
+    operations per transfer, and keep counting across close() and open()
+    until they are reset with resetStatistics(). A low average number of
+    bytes per read call, or many more read calls than readyRead() signals,
+    point to per-byte wake-ups that read batching, a larger read chunk or
+    the read thread can avoid.
+
+    \note The counters are read one by one, so a snapshot taken while the
+    read thread is running is not necessarily consistent across fields.
+
+    \sa resetStatistics(), setReadBatchingEnabled()
+*/
+QSerialPort::Statistics QSerialPort::statistics() const
+{
+    Q_D(const QSerialPort);
+    return d->statistics.snapshot();
+}
+
+/*!
+    \since 6.2
+
+    Resets all I/O counters of the serial port to zero.
+
+    \sa statistics()
+*/
+void QSerialPort::resetStatistics()
+{
+    Q_D(QSerialPort);
+    d->statistics.reset();
+}
+
+/*!
+    \reimp
+
+    Always returns \c true. The serial port is a sequential device.
+*/
+bool QSerialPort::isSequential() const
+{
+    return true;
+}
+
+/*!
+    \reimp
+
+    Returns the number of incoming bytes that are waiting to be read.
+
+    \sa bytesToWrite(), read()
+*/
+qint64 QSerialPort::bytesAvailable() const
+{
+    return QIODevice::bytesAvailable();
+}
+
+/*!
+    \reimp
+
+    Returns the number of bytes that are waiting to be written. The
+    bytes are written when control goes back to the event loop or
+    when flush() is called.
+
+    \sa bytesAvailable(), flush()
+*/
+qint64 QSerialPort::bytesToWrite() const
+{
+    qint64 pendingBytes = QIODevice::bytesToWrite();
+#if defined(Q_OS_WIN32)
+    pendingBytes += d_func()->writeChunkBuffer.size();
+#elif QT_CONFIG(liburing)
+    Q_D(const QSerialPort);
+    for (const QByteArray &chunk : d->ioUringWriteChunks)
+        pendingBytes += chunk.size();
+    if (!d->ioUringWriteChunks.isEmpty())
+        pendingBytes -= d->ioUringWriteOffset;
+#endif
+    return pendingBytes;
+}
+
+/*!
+    \reimp
+
+    Returns \c true if a line of data can be read from the serial port;
+    otherwise returns \c false. As for \l{QIODevice::}{readLine()}, a line
+    ends with \c "\n", whatever the lineTerminator() is.
+
+    Only the data received since the previous call is searched, so calling
+    this function on every \l{QIODevice::}{readyRead()} signal remains
+    cheap while a long line is coming in.
+
+    \sa readLine(), canReadTerminatedLine()
+*/
+bool QSerialPort::canReadLine() const
+{
+    Q_D(const QSerialPort);
+
+    // A transaction keeps the data it has read in the buffer.
+    if (d->transactionStarted)
+        return QIODevice::canReadLine();
+
+    static const QByteArray newline(1, '\n');
+    return d->findLineEnd(newline, &d->newlineScan) >= 0;
+}
+
+/*!
+    \since 6.2
+
+    Returns \c true if a line ending with the lineTerminator() can be read
+    with readTerminatedLine(); otherwise returns \c false.
+
+    Like canReadLine(), this function only searches the data received
+    since the previous call.
+
+    \sa readTerminatedLine(), setLineTerminator()
+*/
+bool QSerialPort::canReadTerminatedLine() const
+{
+    Q_D(const QSerialPort);
+    return d->findLineEnd(d->lineTerminator, &d->terminatorScan) >= 0;
+}
+
+/*!
+    \since 6.2
+
+    Returns the sequence of bytes which ends a line.
+
+    \sa setLineTerminator()
+*/
+QByteArray QSerialPort::lineTerminator() const
+{
+    Q_D(const QSerialPort);
+    return d->lineTerminator;
+}
+
+/*!
+    \since 6.2
+
+    Sets the sequence of bytes which ends a line to \a terminator, for
+    example \c "\r\n" or a single byte such as \c "\r". The default is
+    \c "\n". An empty \a terminator restores the default.
+
+    The terminator is used by canReadTerminatedLine() and
+    readTerminatedLine(). canReadLine() and QIODevice::readLine() always
+    look for \c "\n".
+
+    \sa lineTerminator()
+*/
+void QSerialPort::setLineTerminator(const QByteArray &terminator)
+{
+    Q_D(QSerialPort);
+    d->lineTerminator = terminator.isEmpty() ? QByteArray(1, '\n') : terminator;
+    d->terminatorScan.tail = -1;
+}
+
+/*!
+    \since 6.2
+
+    Reads a line ending with the lineTerminator() from the read buffer and
+    returns it, including the terminator. Returns an empty byte array if no
+    complete line has been received yet.
+
+    If \a maxSize is greater than \c 0, at most \a maxSize bytes are read.
+    A longer line is returned in parts of \a maxSize bytes, with only the
+    last part ending with the terminator.
+
+    \sa canReadTerminatedLine(), setLineTerminator()
+*/
+QByteArray QSerialPort::readTerminatedLine(qint64 maxSize)
+{
+    Q_D(QSerialPort);
+
+    const qint64 terminatorPosition = d->findLineEnd(d->lineTerminator, &d->terminatorScan);
+    qint64 lineSize = terminatorPosition < 0
+            ? 0 : terminatorPosition + d->lineTerminator.size();
+    if (maxSize > 0 && (lineSize > maxSize || (lineSize == 0 && d->buffer.size() >= maxSize)))
+        lineSize = maxSize;
+
+    return lineSize > 0 ? read(lineSize) : QByteArray();
+}
+
+/*!
+    \since 6.2
+
+    Returns the data in the internal read buffer as a list of contiguous
+    spans, in the order in which the data was received. The spans point
+    directly into the read buffer, so no data is copied.
+
+    Together with consume(), this allows parsing incoming data in place:
+
+    \code
+    qint64 parsed = 0;
+    for (QByteArrayView span : serial.readableSpans()) {
+        const qsizetype used = parser.feed(span);
+        parsed += used;
+        if (used < span.size())
+            break;
+    }
+    serial.consume(parsed);
+    \endcode
+
+    \warning The returned views are invalidated by any function which reads
+    from or consumes the read buffer, and by returning to the event loop.
+
+    \sa consume(), bytesAvailable()
+*/
+QList<QByteArrayView> QSerialPort::readableSpans() const
+{
+    Q_D(const QSerialPort);
+
+    QList<QByteArrayView> spans;
+    const qint64 bufferSize = d->buffer.size();
+    qint64 position = 0;
+    while (position < bufferSize) {
+        qint64 length = 0;
+        const char *data = d->buffer.readPointerAtPosition(position, length);
+        if (!data || length <= 0)
+            break;
+        spans.append(QByteArrayView(data, length));
+        position += length;
+    }
+    return spans;
+}
+
+/*!
+    \since 6.2
+
+    Discards up to \a size bytes from the beginning of the internal read
+    buffer without copying them, and returns the number of bytes discarded.
+
+    This is the counterpart of readableSpans(), to be called once the data
+    has been processed in place.
+
+    \sa readableSpans(), QIODevice::skip()
+*/
+qint64 QSerialPort::consume(qint64 size)
+{
+    Q_D(QSerialPort);
+
+    if (size <= 0 || !isReadable())
+        return 0;
+
+    const qint64 consumed = skip(qMin(size, d->buffer.size()));
+
+    // As in readData(), restart the notifications in case they were
+    // disabled because the read buffer was full.
+    d->startAsyncRead();
+
+    return qMax(consumed, qint64(0));
 }
 
 /*!
@@ -1242,7 +2894,10 @@ qint64 QSerialPort::readLineData(char *data, qint64 maxSize)
 qint64 QSerialPort::writeData(const char *data, qint64 maxSize)
 {
     Q_D(QSerialPort);
-    return d->writeData(data, maxSize);
+    const qint64 written = d->writeData(data, maxSize);
+    if (written > 0)
+        d->statistics.recordWriteBufferSize(bytesToWrite());
+    return written;
 }
 
 QT_END_NAMESPACE
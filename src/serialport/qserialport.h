@@ -41,7 +41,9 @@
 #ifndef QSERIALPORT_H
 #define QSERIALPORT_H
 
+#include <QtCore/qbytearrayview.h>
 #include <QtCore/qiodevice.h>
+#include <QtCore/qlist.h>
 
 #include <QtSerialPort/qserialportglobal.h>
 
@@ -158,6 +160,74 @@ public:
     };
     Q_ENUM(SerialPortError)
 
+    enum ReadChunkPolicy {
+        FixedReadChunk,
+        AvailableReadChunk,
+        AdaptiveReadChunk
+    };
+    Q_ENUM(ReadChunkPolicy)
+
+    enum WritePolicy {
+        DeferredWrite,
+        ImmediateWrite,
+        CoalescedWrite
+    };
+    Q_ENUM(WritePolicy)
+
+    enum LowLatencyFeature {
+        NoLowLatencyFeature = 0x00,
+        AsyncLowLatencyFeature = 0x01,
+        LatencyTimerFeature = 0x02
+    };
+    Q_FLAG(LowLatencyFeature)
+    Q_DECLARE_FLAGS(LowLatencyFeatures, LowLatencyFeature)
+
+    enum LockingStrategy {
+        LockFileLocking,
+        DescriptorLocking,
+        ExclusiveModeLocking,
+        NoLocking
+    };
+    Q_ENUM(LockingStrategy)
+
+    struct ReceiveTimestamp
+    {
+        qint64 offset;
+        qint64 timestamp;
+    };
+
+    struct Statistics
+    {
+        qint64 readCalls = 0;
+        qint64 emptyReadCalls = 0;
+        qint64 bytesRead = 0;
+        qint64 minimumBytesPerRead = 0;
+        qint64 maximumBytesPerRead = 0;
+        qint64 writeCalls = 0;
+        qint64 bytesWritten = 0;
+        qint64 minimumBytesPerWrite = 0;
+        qint64 maximumBytesPerWrite = 0;
+        qint64 readyReadSignals = 0;
+        qint64 bytesWrittenSignals = 0;
+        qint64 readBufferHighWaterMark = 0;
+        qint64 writeBufferHighWaterMark = 0;
+
+        double averageBytesPerRead() const
+        { return readCalls ? double(bytesRead) / readCalls : 0.0; }
+        double averageBytesPerWrite() const
+        { return writeCalls ? double(bytesWritten) / writeCalls : 0.0; }
+    };
+
+    struct Configuration
+    {
+        qint32 inputBaudRate = Baud9600;
+        qint32 outputBaudRate = Baud9600;
+        DataBits dataBits = Data8;
+        Parity parity = NoParity;
+        StopBits stopBits = OneStop;
+        FlowControl flowControl = NoFlowControl;
+    };
+
     explicit QSerialPort(QObject *parent = nullptr);
     explicit QSerialPort(const QString &name, QObject *parent = nullptr);
     explicit QSerialPort(const QSerialPortInfo &info, QObject *parent = nullptr);
@@ -171,6 +241,9 @@ public:
     bool open(OpenMode mode) override;
     void close() override;
 
+    LockingStrategy lockingStrategy() const;
+    void setLockingStrategy(LockingStrategy strategy);
+
     bool setBaudRate(qint32 baudRate, Directions directions = AllDirections);
     qint32 baudRate(Directions directions = AllDirections) const;
 
@@ -190,6 +263,9 @@ public:
     FlowControl flowControl() const;
     QBindable<FlowControl> bindableFlowControl();
 
+    Configuration configuration() const;
+    bool applyConfiguration(const Configuration &configuration);
+
     bool setDataTerminalReady(bool set);
     bool isDataTerminalReady();
 
@@ -208,11 +284,67 @@ public:
     qint64 readBufferSize() const;
     void setReadBufferSize(qint64 size);
 
+    ReadChunkPolicy readChunkPolicy() const;
+    void setReadChunkPolicy(ReadChunkPolicy policy);
+
+    qint64 readChunkSize() const;
+    void setReadChunkSize(qint64 size);
+
+    bool isReadBatchingEnabled() const;
+    void setReadBatchingEnabled(bool enable);
+
+    qint64 readBatchByteLimit() const;
+    void setReadBatchByteLimit(qint64 size);
+
+    int readBatchTimeLimit() const;
+    void setReadBatchTimeLimit(int usecs);
+
+    qint64 readBatchCount() const;
+    qint64 batchedReadCount() const;
+    void resetReadBatchCounters();
+
+    bool isReadThreadEnabled() const;
+    void setReadThreadEnabled(bool enable);
+
+    qint64 readThreadBufferSize() const;
+    void setReadThreadBufferSize(qint64 size);
+
+    WritePolicy writePolicy() const;
+    void setWritePolicy(WritePolicy policy);
+
+    qint64 writeCoalescingByteLimit() const;
+    void setWriteCoalescingByteLimit(qint64 size);
+
+    int writeCoalescingTimeLimit() const;
+    void setWriteCoalescingTimeLimit(int usecs);
+
+    bool setLowLatencyMode(bool enable);
+    bool isLowLatencyMode() const;
+    LowLatencyFeatures lowLatencyFeatures() const;
+
+    double frameIdleGap() const;
+    void setFrameIdleGap(double characterTimes);
+
     bool isSequential() const override;
 
     qint64 bytesAvailable() const override;
     qint64 bytesToWrite() const override;
     bool canReadLine() const override;
+    bool canReadTerminatedLine() const;
+
+    QByteArray lineTerminator() const;
+    void setLineTerminator(const QByteArray &terminator);
+    QByteArray readTerminatedLine(qint64 maxSize = 0);
+
+    QList<QByteArrayView> readableSpans() const;
+    qint64 consume(qint64 size);
+
+    bool isReceiveTimestampingEnabled() const;
+    void setReceiveTimestampingEnabled(bool enable);
+    QByteArray readWithTimestamps(QList<ReceiveTimestamp> *timestamps, qint64 maxSize = -1);
+
+    Statistics statistics() const;
+    void resetStatistics();
 
     bool waitForReadyRead(int msecs = 30000) override;
     bool waitForBytesWritten(int msecs = 30000) override;
@@ -233,6 +365,7 @@ Q_SIGNALS:
     void requestToSendChanged(bool set);
     void errorOccurred(QSerialPort::SerialPortError error);
     void breakEnabledChanged(bool set);
+    void frameReceived(const QByteArray &frame);
 
 protected:
     qint64 readData(char *data, qint64 maxSize) override;
@@ -249,6 +382,11 @@ private:
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(QSerialPort::Directions)
 Q_DECLARE_OPERATORS_FOR_FLAGS(QSerialPort::PinoutSignals)
+Q_DECLARE_OPERATORS_FOR_FLAGS(QSerialPort::LowLatencyFeatures)
+
+Q_DECLARE_TYPEINFO(QSerialPort::ReceiveTimestamp, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QSerialPort::Statistics, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QSerialPort::Configuration, Q_PRIMITIVE_TYPE);
 
 QT_END_NAMESPACE
 
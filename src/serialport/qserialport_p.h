@@ -54,6 +54,9 @@
 //
 
 #include "qserialport.h"
+#include "qserialportstatistics_p.h"
+
+#include <QtSerialPort/private/qtserialport-config_p.h>
 
 #include <qdeadlinetimer.h>
 
@@ -68,7 +71,12 @@
 #  include <QtCore/qfileinfo.h>
 #  include <QtCore/qstringlist.h>
 #  include <limits.h>
+#  include <limits>
 #  include <termios.h>
+#  if QT_CONFIG(liburing)
+#    include <QtCore/qbytearraylist.h>
+#    include <sys/uio.h>
+#  endif
 #  ifdef Q_OS_ANDROID
 struct serial_struct {
     int     type;
@@ -92,6 +100,7 @@ struct serial_struct {
 };
 #    define ASYNC_SPD_CUST  0x0030
 #    define ASYNC_SPD_MASK  0x1030
+#    define ASYNC_LOW_LATENCY 0x2000
 #    define PORT_UNKNOWN    0
 #  elif defined(Q_OS_LINUX)
 #    include <linux/serial.h>
@@ -108,9 +117,15 @@ QT_BEGIN_NAMESPACE
 
 class QTimer;
 class QSocketNotifier;
+#if defined(Q_OS_UNIX)
+class QSerialPortReadThread;
+class QSerialPortGroupPrivate;
+class QSerialPortIoUring;
+#endif
 
 #if defined(Q_OS_UNIX)
-QString serialPortLockFilePath(const QString &portName);
+Q_AUTOTEST_EXPORT QString serialPortLockFilePath(const QString &portName);
+Q_AUTOTEST_EXPORT void invalidateSerialPortLockDirectory();
 #endif
 
 class QSerialPortErrorInfo
@@ -122,12 +137,29 @@ public:
     QString errorString;
 };
 
+// Returns the index of the first occurrence of byte in data, or -1.
+Q_AUTOTEST_EXPORT qsizetype qt_serialport_find_byte(const char *data, qsizetype size, char byte);
+#if defined(QT_BUILD_INTERNAL)
+// Makes qt_serialport_find_byte() skip its AVX2 loop, so that the tests
+// reach the SSE2 one on any x86 machine.
+extern Q_AUTOTEST_EXPORT bool qt_serialport_find_byte_avx2_disabled;
+#endif
+
+// Returns the position of the first delimiter in buffer at or after
+// position, or -1. In that case, resumePosition receives the position at
+// which the search has to resume once more data has been appended.
+qint64 qt_serialport_find_delimiter(const QRingBufferRef &buffer, qint64 position,
+                                    const QByteArray &delimiter, qint64 *resumePosition);
+
 class QSerialPortPrivate : public QIODevicePrivate
 {
     Q_DECLARE_PUBLIC(QSerialPort)
 public:
     QSerialPortPrivate();
 
+    static QSerialPortPrivate *get(QSerialPort *port)
+    { return port->d_func(); }
+
     bool open(QIODevice::OpenMode mode);
     void close();
 
@@ -151,6 +183,7 @@ public:
     bool setParity(QSerialPort::Parity parity);
     bool setStopBits(QSerialPort::StopBits stopBits);
     bool setFlowControl(QSerialPort::FlowControl flowControl);
+    bool applyConfiguration(const QSerialPort::Configuration &configuration);
 
     QSerialPortErrorInfo getSystemError(int systemErrorCode = -1) const;
 
@@ -165,7 +198,83 @@ public:
 
     static QList<qint32> standardBaudRates();
 
+    qint64 queuedBytesCount(QSerialPort::Direction direction) const;
+
+    qint64 nextReadChunkSize();
+    qint64 adaptiveReadChunkFloor() const;
+    void updateAdaptiveReadChunkSize(qint64 requestedBytes, qint64 readBytes);
+
     qint64 readBufferMaxSize = 0;
+    QSerialPort::ReadChunkPolicy readChunkPolicy = QSerialPort::FixedReadChunk;
+    qint64 readChunkSize = QSERIALPORT_BUFFERSIZE;
+    qint64 adaptiveReadChunkSize = 0;
+
+    bool readBatchingEnabled = false;
+    qint64 readBatchByteLimit = 1024 * 1024;
+    int readBatchTimeLimit = 1000;
+    qint64 readBatchCount = 0;
+    qint64 batchedReadCount = 0;
+
+    QSerialPort::WritePolicy writePolicy = QSerialPort::DeferredWrite;
+    qint64 writeCoalescingByteLimit = 4096;
+    int writeCoalescingTimeLimit = 1000;
+
+    int writeCoalescingInterval() const
+    { return (writeCoalescingTimeLimit + 999) / 1000; }
+
+    bool applyLowLatencyMode();
+    void restoreLowLatencyMode();
+
+    bool lowLatencyMode = false;
+    QSerialPort::LowLatencyFeatures lowLatencyFeatures = QSerialPort::NoLowLatencyFeature;
+
+    qint64 characterTimeNsecs() const;
+    qint64 frameIdleGapNsecs() const;
+    void takeFrameData();
+    void restoreFrameData();
+    void frameIdleNotification();
+    void startFrameIdleTimer();
+    void stopFrameIdleTimer();
+
+    void recordReceivedData(qint64 bytes);
+    void discardReceiveTimestamps();
+
+    // The bytes at the end of the read buffer not searched for a line end
+    // yet, as of receivedByteCount; -1 if none were searched.
+    struct LineScan
+    {
+        qint64 tail = -1;
+        qint64 receivedCount = 0;
+    };
+    qint64 findLineEnd(const QByteArray &terminator, LineScan *scan) const;
+
+    // Counts all bytes appended to the read buffer, so the unread data is
+    // the range of buffer.size() bytes before receivedByteCount.
+    qint64 receivedByteCount = 0;
+
+    // Consumed timestamp entries are skipped by moving the head.
+    bool receiveTimestampingEnabled = false;
+    QList<QSerialPort::ReceiveTimestamp> receiveTimestamps;
+    qsizetype receiveTimestampHead = 0;
+
+    QByteArray lineTerminator = QByteArray(1, '\n');
+    // canReadLine() looks for '\n' as QIODevice::readLine() does, the
+    // terminated line functions for the lineTerminator.
+    mutable LineScan newlineScan;
+    mutable LineScan terminatorScan;
+
+    QSerialPortStatisticsCounters statistics;
+
+    bool readThreadEnabled = false;
+    qint64 readThreadBufferSize = 1024 * 1024;
+
+    QSerialPort::LockingStrategy lockingStrategy = QSerialPort::LockFileLocking;
+
+    double frameIdleGap = 0;
+    QByteArray frameBuffer;
+    qint64 frameStartTime = 0;
+    qint64 frameDeadline = 0;
+    QTimer *frameIdleTimer = nullptr;
 
     void setBindableError(QSerialPort::SerialPortError error)
     { setError(error); }
@@ -210,8 +319,6 @@ public:
     bool setDcb(DCB *dcb);
     bool getDcb(DCB *dcb);
 
-    qint64 queuedBytesCount(QSerialPort::Direction direction) const;
-
     bool completeAsyncCommunication(qint64 bytesTransferred);
     bool completeAsyncRead(qint64 bytesTransferred);
     bool completeAsyncWrite(qint64 bytesTransferred);
@@ -238,6 +345,7 @@ public:
     bool readStarted = false;
     qint64 writeBytesTransferred = 0;
     qint64 readBytesTransferred = 0;
+    qint64 readBytesRequested = 0;
     QTimer *startAsyncWriteTimer = nullptr;
     class Overlapped *communicationCompletionOverlapped = nullptr;
     class Overlapped *readCompletionOverlapped = nullptr;
@@ -246,10 +354,12 @@ public:
 
 #elif defined(Q_OS_UNIX)
 
-    static qint32 settingFromBaudRate(qint32 baudRate);
+    Q_AUTOTEST_EXPORT static qint32 settingFromBaudRate(qint32 baudRate);
+    static qint32 baudRateFromSetting(qint32 setting);
 
     bool setTermios(const termios *tio);
     bool getTermios(termios *tio);
+    bool verifyTermios();
 
     bool setCustomBaudRate(qint32 baudRate, QSerialPort::Directions directions);
     bool setStandardBaudRate(qint32 baudRate, QSerialPort::Directions directions);
@@ -261,13 +371,41 @@ public:
 
     bool waitForReadOrWrite(bool *selectForRead, bool *selectForWrite,
                             bool checkRead, bool checkWrite,
-                            int msecs);
+                            QDeadlineTimer deadline);
+    bool pollForReadOrWrite(bool *selectForRead, bool *selectForWrite,
+                            bool checkRead, bool checkWrite,
+                            QDeadlineTimer deadline);
+#ifdef Q_OS_LINUX
+    bool openWaitDescriptor();
+    void closeWaitDescriptor();
+    bool waitForEvents(bool *selectForRead, bool *selectForWrite,
+                       bool checkRead, bool checkWrite,
+                       QDeadlineTimer deadline);
+#endif
 
     qint64 readFromPort(char *data, qint64 maxSize);
     qint64 writeToPort(const char *data, qint64 maxSize);
+    qint64 writeBufferToPort();
 
 #ifndef CMSPAR
     qint64 writePerChar(const char *data, qint64 maxSize);
+    void takeOverPendingInput();
+#endif
+
+    bool isReadBufferFull() const;
+    qint64 readIntoBuffer();
+    bool readFromPortIntoBuffer();
+    bool startReadThread();
+    bool readFromReadThread();
+    void deliverReadData(qint64 newBytes);
+
+#if QT_CONFIG(liburing)
+    bool startIoUringRead();
+    bool startIoUringWrite();
+    void completeIoUringOperation(int type, int result);
+    void completeIoUringRead(int result);
+    void completeIoUringWrite(int result);
+    bool waitForIoUring(int msecs, bool *completed);
 #endif
 
     bool readNotification();
@@ -276,9 +414,69 @@ public:
 
     struct termios restoredTermios;
     int descriptor = -1;
+    bool exclusiveModeSet = false;
+
+    // The settings last committed with setTermios(), which getTermios()
+    // returns without asking the driver. Requests that change the settings
+    // in other ways, such as TCSETS2, invalidate it.
+    struct termios cachedTermios;
+    bool cachedTermiosValid = false;
+    bool termiosVerificationEnabled = false;
+#ifdef Q_OS_LINUX
+    // Whether a custom baud rate may be in effect, which has to be cleared
+    // before a standard one can be set with tcsetattr().
+    bool customBaudRateMayBeSet = true;
+#endif
+
+#ifdef Q_OS_LINUX
+    bool restoredAsyncLowLatency = false;
+    QByteArray restoredLatencyTimer;
+#endif
 
     QSocketNotifier *readNotifier = nullptr;
     QSocketNotifier *writeNotifier = nullptr;
+    QTimer *writeCoalescingTimer = nullptr;
+    QSerialPortReadThread *readThread = nullptr;
+    QSerialPortIoUring *ioUring = nullptr;
+
+#if QT_CONFIG(liburing)
+    int ioUringPendingOperations = 0;
+    bool ioUringReadEnabled = false;
+    bool ioUringReadStarted = false;
+    bool ioUringReadCompleted = false;
+    bool ioUringWriteCompleted = false;
+    int ioUringReadPollError = 0;
+    int ioUringWritePollError = 0;
+    qint64 ioUringReadRequested = 0;
+    QByteArray ioUringReadBuffer;
+    // The write buffer blocks in flight, the first one from the offset on.
+    QByteArrayList ioUringWriteChunks;
+    qint64 ioUringWriteOffset = 0;
+    iovec ioUringWriteVectors[16];
+#endif
+
+    QSerialPortGroupPrivate *group = nullptr;
+    quint64 groupKey = 0;
+    bool groupRegistered = false;
+    bool groupReadNotificationEnabled = false;
+    bool groupWriteNotificationEnabled = false;
+
+#ifdef Q_OS_LINUX
+    int frameIdleDescriptor = -1;
+    QSocketNotifier *frameIdleNotifier = nullptr;
+#endif
+
+#ifdef Q_OS_LINUX
+    // The blocking waitFor*() functions wait on an epoll instance that
+    // keeps the port and a deadline timer registered while it is open.
+    int waitDescriptor = -1;
+    int waitTimerDescriptor = -1;
+    quint32 waitPortEvents = 0;
+    quint32 waitReadThreadEvents = 0;
+    qint64 waitDeadline = std::numeric_limits<qint64>::max();
+#endif
+
+    bool drainingRead = false;
 
     bool readPortNotifierCalled = false;
     bool readPortNotifierState = false;
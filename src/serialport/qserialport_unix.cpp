@@ -41,18 +41,35 @@
 
 #include "qserialport_p.h"
 #include "qserialportinfo_p.h"
+#include "qserialportgroup_p.h"
+#include "qserialportreadthread_p.h"
+#if QT_CONFIG(liburing)
+#include "qserialportiouring_p.h"
+#endif
 
 #include <QtCore/qelapsedtimer.h>
+#include <QtCore/qfile.h>
 #include <QtCore/qmap.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qscopedvaluerollback.h>
 #include <QtCore/qsocketnotifier.h>
 #include <QtCore/qstandardpaths.h>
+#include <QtCore/qtimer.h>
 
 #include <private/qcore_unix_p.h>
 
+#include <qtserialport_tracepoints_p.h>
+
 #include <errno.h>
 #include <fcntl.h>
+#include <sys/file.h>
 #include <sys/ioctl.h>
 #include <sys/time.h>
+#ifdef Q_OS_LINUX
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#endif
+#include <sys/uio.h>
 #include <unistd.h>
 
 #ifdef Q_OS_OSX
@@ -98,13 +115,21 @@ struct termios2 {
 #define BOTHER      0010000
 #endif
 
+#ifndef CIBAUD
+#define CIBAUD      002003600000
+#endif
+
+#ifndef IBSHIFT
+#define IBSHIFT     16
+#endif
+
 #endif
 
 QT_BEGIN_NAMESPACE
 
-QString serialPortLockFilePath(const QString &portName)
+static const QStringList &lockDirectoryPaths()
 {
-    static const QStringList lockDirectoryPaths = QStringList()
+    static const QStringList paths = QStringList()
         << QStringLiteral("/var/lock")
         << QStringLiteral("/etc/locks")
         << QStringLiteral("/var/spool/locks")
@@ -117,40 +142,79 @@ QString serialPortLockFilePath(const QString &portName)
         << QStringLiteral("/data/local/tmp")
 #endif
         << QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+    return paths;
+}
+
+// The lock directory is chosen once per process. The readable directories
+// before it are kept as well, because a lock file that already exists in
+// one of them still takes precedence.
+struct LockDirectoryCache
+{
+    QBasicMutex mutex;
+    QStringList precedingDirectories;
+    QString directory;
+};
+
+Q_GLOBAL_STATIC(LockDirectoryCache, lockDirectoryCache)
 
+QString serialPortLockFilePath(const QString &portName)
+{
     QString fileName = portName;
     fileName.replace(QLatin1Char('/'), QLatin1Char('_'));
     fileName.prepend(QLatin1String("/LCK.."));
 
-    QString lockFilePath;
-
-    for (const QString &lockDirectoryPath : lockDirectoryPaths) {
-        const QString filePath = lockDirectoryPath + fileName;
-
-        QFileInfo lockDirectoryInfo(lockDirectoryPath);
-        if (lockDirectoryInfo.isReadable()) {
-            if (QFile::exists(filePath) || lockDirectoryInfo.isWritable()) {
-                lockFilePath = filePath;
-                break;
+    QStringList precedingDirectories;
+    QString lockDirectoryPath;
+    {
+        LockDirectoryCache *cache = lockDirectoryCache();
+        QMutexLocker locker(&cache->mutex);
+        if (cache->directory.isEmpty()) {
+            cache->precedingDirectories.clear();
+            for (const QString &path : lockDirectoryPaths()) {
+                QFileInfo lockDirectoryInfo(path);
+                if (!lockDirectoryInfo.isReadable())
+                    continue;
+                if (lockDirectoryInfo.isWritable()) {
+                    cache->directory = path;
+                    break;
+                }
+                cache->precedingDirectories.append(path);
             }
         }
+        precedingDirectories = cache->precedingDirectories;
+        lockDirectoryPath = cache->directory;
     }
 
-    if (lockFilePath.isEmpty()) {
+    for (const QString &path : qAsConst(precedingDirectories)) {
+        const QString filePath = path + fileName;
+        if (QFile::exists(filePath))
+            return filePath;
+    }
+
+    if (lockDirectoryPath.isEmpty()) {
         qWarning("The following directories are not readable or writable for detaling with lock files\n");
-        for (const QString &lockDirectoryPath : lockDirectoryPaths)
-            qWarning("\t%s\n", qPrintable(lockDirectoryPath));
+        for (const QString &path : lockDirectoryPaths())
+            qWarning("\t%s\n", qPrintable(path));
         return QString();
     }
 
-    return lockFilePath;
+    return lockDirectoryPath + fileName;
+}
+
+void invalidateSerialPortLockDirectory()
+{
+    LockDirectoryCache *cache = lockDirectoryCache();
+    QMutexLocker locker(&cache->mutex);
+    cache->precedingDirectories.clear();
+    cache->directory.clear();
 }
 
 class ReadNotifier : public QSocketNotifier
 {
 public:
     explicit ReadNotifier(QSerialPortPrivate *d, QObject *parent)
-        : QSocketNotifier(d->descriptor, QSocketNotifier::Read, parent)
+        : QSocketNotifier(d->readThread ? d->readThread->notificationDescriptor() : d->descriptor,
+                          QSocketNotifier::Read, parent)
         , dptr(d)
     {
     }
@@ -192,6 +256,33 @@ private:
     QSerialPortPrivate * const dptr;
 };
 
+#ifdef Q_OS_LINUX
+class FrameIdleNotifier : public QSocketNotifier
+{
+public:
+    explicit FrameIdleNotifier(QSerialPortPrivate *d, QObject *parent)
+        : QSocketNotifier(d->frameIdleDescriptor, QSocketNotifier::Read, parent)
+        , dptr(d)
+    {
+    }
+
+protected:
+    bool event(QEvent *e) override
+    {
+        if (e->type() == QEvent::SockAct) {
+            quint64 expirations = 0;
+            qt_safe_read(dptr->frameIdleDescriptor, &expirations, sizeof(expirations));
+            dptr->frameIdleNotification();
+            return true;
+        }
+        return QSocketNotifier::event(e);
+    }
+
+private:
+    QSerialPortPrivate * const dptr;
+};
+#endif
+
 static inline void qt_set_common_props(termios *tio, QIODevice::OpenMode m)
 {
 #ifdef Q_OS_SOLARIS
@@ -212,7 +303,9 @@ static inline void qt_set_common_props(termios *tio, QIODevice::OpenMode m)
         tio->c_cflag |= CREAD;
 }
 
-static inline void qt_set_databits(termios *tio, QSerialPort::DataBits databits)
+// The line setting helpers fill in termios as well as termios2.
+template <typename Termios>
+static inline void qt_set_databits(Termios *tio, QSerialPort::DataBits databits)
 {
     tio->c_cflag &= ~CSIZE;
     switch (databits) {
@@ -234,7 +327,8 @@ static inline void qt_set_databits(termios *tio, QSerialPort::DataBits databits)
     }
 }
 
-static inline void qt_set_parity(termios *tio, QSerialPort::Parity parity)
+template <typename Termios>
+static inline void qt_set_parity(Termios *tio, QSerialPort::Parity parity)
 {
     tio->c_iflag &= ~(PARMRK | INPCK);
     tio->c_iflag |= IGNPAR;
@@ -269,7 +363,8 @@ static inline void qt_set_parity(termios *tio, QSerialPort::Parity parity)
     }
 }
 
-static inline void qt_set_stopbits(termios *tio, QSerialPort::StopBits stopbits)
+template <typename Termios>
+static inline void qt_set_stopbits(Termios *tio, QSerialPort::StopBits stopbits)
 {
     switch (stopbits) {
     case QSerialPort::OneStop:
@@ -284,7 +379,8 @@ static inline void qt_set_stopbits(termios *tio, QSerialPort::StopBits stopbits)
     }
 }
 
-static inline void qt_set_flowcontrol(termios *tio, QSerialPort::FlowControl flowcontrol)
+template <typename Termios>
+static inline void qt_set_flowcontrol(Termios *tio, QSerialPort::FlowControl flowcontrol)
 {
     switch (flowcontrol) {
     case QSerialPort::NoFlowControl:
@@ -308,19 +404,35 @@ static inline void qt_set_flowcontrol(termios *tio, QSerialPort::FlowControl flo
 
 bool QSerialPortPrivate::open(QIODevice::OpenMode mode)
 {
-    QString lockFilePath = serialPortLockFilePath(QSerialPortInfoPrivate::portNameFromSystemLocation(systemLocation));
-    bool isLockFileEmpty = lockFilePath.isEmpty();
-    if (isLockFileEmpty) {
-        qWarning("Failed to create a lock file for opening the device");
-        setError(QSerialPortErrorInfo(QSerialPort::PermissionError, QSerialPort::tr("Permission error while creating lock file")));
-        return false;
-    }
+    QScopedPointer<QLockFile> newLockFileScopedPointer;
+
+    if (lockingStrategy == QSerialPort::LockFileLocking) {
+        const QString portName = QSerialPortInfoPrivate::portNameFromSystemLocation(systemLocation);
+        QString lockFilePath = serialPortLockFilePath(portName);
+        bool isLockFileEmpty = lockFilePath.isEmpty();
+        if (isLockFileEmpty) {
+            qWarning("Failed to create a lock file for opening the device");
+            setError(QSerialPortErrorInfo(QSerialPort::PermissionError, QSerialPort::tr("Permission error while creating lock file")));
+            return false;
+        }
 
-    QScopedPointer<QLockFile> newLockFileScopedPointer(new QLockFile(lockFilePath));
+        newLockFileScopedPointer.reset(new QLockFile(lockFilePath));
 
-    if (!newLockFileScopedPointer->tryLock()) {
-        setError(QSerialPortErrorInfo(QSerialPort::PermissionError, QSerialPort::tr("Permission error while locking the device")));
-        return false;
+        bool isLocked = newLockFileScopedPointer->tryLock();
+        if (!isLocked && newLockFileScopedPointer->error() != QLockFile::LockFailedError) {
+            // The lock directory chosen before may have become unusable since.
+            invalidateSerialPortLockDirectory();
+            const QString newLockFilePath = serialPortLockFilePath(portName);
+            if (!newLockFilePath.isEmpty() && newLockFilePath != lockFilePath) {
+                newLockFileScopedPointer.reset(new QLockFile(newLockFilePath));
+                isLocked = newLockFileScopedPointer->tryLock();
+            }
+        }
+
+        if (!isLocked) {
+            setError(QSerialPortErrorInfo(QSerialPort::PermissionError, QSerialPort::tr("Permission error while locking the device")));
+            return false;
+        }
     }
 
     int flags = O_NOCTTY | O_NONBLOCK;
@@ -344,6 +456,19 @@ bool QSerialPortPrivate::open(QIODevice::OpenMode mode)
         return false;
     }
 
+    if (lockingStrategy == QSerialPort::DescriptorLocking) {
+        int result;
+        EINTR_LOOP(result, ::flock(descriptor, LOCK_EX | LOCK_NB));
+        if (result == -1) {
+            if (errno == EWOULDBLOCK)
+                setError(QSerialPortErrorInfo(QSerialPort::PermissionError, QSerialPort::tr("Permission error while locking the device")));
+            else
+                setError(getSystemError());
+            qt_safe_close(descriptor);
+            return false;
+        }
+    }
+
     if (!initialize(mode)) {
         qt_safe_close(descriptor);
         return false;
@@ -356,19 +481,56 @@ bool QSerialPortPrivate::open(QIODevice::OpenMode mode)
 
 void QSerialPortPrivate::close()
 {
-    if (settingsRestoredOnClose)
+    if (settingsRestoredOnClose) {
         ::tcsetattr(descriptor, TCSANOW, &restoredTermios);
+        restoreLowLatencyMode();
+    }
+    cachedTermiosValid = false;
+    lowLatencyFeatures = QSerialPort::NoLowLatencyFeature;
 
 #ifdef TIOCNXCL
-    ::ioctl(descriptor, TIOCNXCL);
+    if (exclusiveModeSet)
+        ::ioctl(descriptor, TIOCNXCL);
 #endif
+    exclusiveModeSet = false;
 
     delete readNotifier;
     readNotifier = nullptr;
 
+    delete readThread;
+    readThread = nullptr;
+
+    if (group) {
+        group->unregisterPort(this);
+        groupReadNotificationEnabled = false;
+        groupWriteNotificationEnabled = false;
+    }
+
+#if QT_CONFIG(liburing)
+    if (ioUring) {
+        ioUring->cancel(this);
+        ioUring->release();
+        ioUring = nullptr;
+        ioUringReadEnabled = false;
+        ioUringReadStarted = false;
+        ioUringWriteChunks.clear();
+        ioUringWriteOffset = 0;
+    }
+#endif
+
     delete writeNotifier;
     writeNotifier = nullptr;
 
+    delete writeCoalescingTimer;
+    writeCoalescingTimer = nullptr;
+
+    stopFrameIdleTimer();
+    frameBuffer.clear();
+
+#ifdef Q_OS_LINUX
+    closeWaitDescriptor();
+#endif
+
     qt_safe_close(descriptor);
 
     lockFileScopedPointer.reset(nullptr);
@@ -459,6 +621,9 @@ bool QSerialPortPrivate::setRequestToSend(bool set)
 
 bool QSerialPortPrivate::flush()
 {
+    // A write in flight in the ring completes by itself.
+    if (ioUring)
+        return startAsyncWrite();
     return completeAsyncWrite();
 }
 
@@ -470,6 +635,12 @@ bool QSerialPortPrivate::clear(QSerialPort::Directions directions)
         return false;
     }
 
+    if (readThread && (directions & QSerialPort::Input)) {
+        QSerialPortReadRing &ring = readThread->ring();
+        ring.release(ring.size());
+        readThread->resumeReading();
+    }
+
     return true;
 }
 
@@ -495,40 +666,61 @@ bool QSerialPortPrivate::setBreakEnabled(bool set)
 
 bool QSerialPortPrivate::waitForReadyRead(int msecs)
 {
-    QElapsedTimer stopWatch;
-    stopWatch.start();
+#if QT_CONFIG(liburing)
+    if (ioUring) {
+        if (!startAsyncWrite() || !startAsyncRead())
+            return false;
+        return waitForIoUring(msecs, &ioUringReadCompleted);
+    }
+#endif
+
+    QDeadlineTimer deadline(msecs);
 
     do {
         bool readyToRead = false;
         bool readyToWrite = false;
         if (!waitForReadOrWrite(&readyToRead, &readyToWrite, true, !writeBuffer.isEmpty(),
-                                qt_subtract_from_timeout(msecs, stopWatch.elapsed()))) {
+                                deadline)) {
             return false;
         }
 
-        if (readyToRead)
+        if (readyToRead) {
+            // Take everything the driver has queued, rather than one chunk
+            // per wakeup.
+            const QScopedValueRollback<bool> drain(drainingRead, true);
             return readNotification();
+        }
 
         if (readyToWrite && !completeAsyncWrite())
             return false;
-    } while (msecs == -1 || qt_subtract_from_timeout(msecs, stopWatch.elapsed()) > 0);
+    } while (!deadline.hasExpired());
     return false;
 }
 
 bool QSerialPortPrivate::waitForBytesWritten(int msecs)
 {
+#if QT_CONFIG(liburing)
+    if (ioUring) {
+        if (writeBuffer.isEmpty() && ioUringWriteChunks.isEmpty() && pendingBytesWritten <= 0)
+            return false;
+        if (!startAsyncWrite())
+            return false;
+        return waitForIoUring(msecs, &ioUringWriteCompleted);
+    }
+#endif
+
     if (writeBuffer.isEmpty() && pendingBytesWritten <= 0)
         return false;
 
-    QElapsedTimer stopWatch;
-    stopWatch.start();
+    QDeadlineTimer deadline(msecs);
 
     for (;;) {
         bool readyToRead = false;
         bool readyToWrite = false;
         const bool checkRead = q_func()->isReadable();
-        if (!waitForReadOrWrite(&readyToRead, &readyToWrite, checkRead, !writeBuffer.isEmpty(),
-                                qt_subtract_from_timeout(msecs, stopWatch.elapsed()))) {
+        const bool checkWrite = !writeBuffer.isEmpty() || pendingBytesWritten > 0;
+        if (!waitForReadOrWrite(&readyToRead, &readyToWrite, checkRead, checkWrite,
+                                deadline)) {
             return false;
         }
 
@@ -553,26 +745,31 @@ bool QSerialPortPrivate::setBaudRate()
 bool QSerialPortPrivate::setStandardBaudRate(qint32 baudRate, QSerialPort::Directions directions)
 {
 #ifdef Q_OS_LINUX
-    // try to clear custom baud rate, using termios v2
-    struct termios2 tio2;
-    if (::ioctl(descriptor, TCGETS2, &tio2) != -1) {
-        if (tio2.c_cflag & BOTHER) {
-            tio2.c_cflag &= ~BOTHER;
-            tio2.c_cflag |= CBAUD;
-            ::ioctl(descriptor, TCSETS2, &tio2);
+    if (customBaudRateMayBeSet) {
+        // try to clear custom baud rate, using termios v2
+        struct termios2 tio2;
+        if (::ioctl(descriptor, TCGETS2, &tio2) != -1) {
+            if (tio2.c_cflag & BOTHER) {
+                tio2.c_cflag &= ~BOTHER;
+                tio2.c_cflag |= CBAUD;
+                ::ioctl(descriptor, TCSETS2, &tio2);
+                cachedTermiosValid = false;
+            }
         }
-    }
 
-    // try to clear custom baud rate, using serial_struct (old way)
-    struct serial_struct serial;
-    ::memset(&serial, 0, sizeof(serial));
-    if (::ioctl(descriptor, TIOCGSERIAL, &serial) != -1) {
-        if (serial.flags & ASYNC_SPD_CUST) {
-            serial.flags &= ~ASYNC_SPD_CUST;
-            serial.custom_divisor = 0;
-            // we don't check on errors because a driver can has not this feature
-            ::ioctl(descriptor, TIOCSSERIAL, &serial);
+        // try to clear custom baud rate, using serial_struct (old way)
+        struct serial_struct serial;
+        ::memset(&serial, 0, sizeof(serial));
+        if (::ioctl(descriptor, TIOCGSERIAL, &serial) != -1) {
+            if (serial.flags & ASYNC_SPD_CUST) {
+                serial.flags &= ~ASYNC_SPD_CUST;
+                serial.custom_divisor = 0;
+                // we don't check on errors because a driver can has not this feature
+                ::ioctl(descriptor, TIOCSSERIAL, &serial);
+            }
         }
+
+        customBaudRateMayBeSet = false;
     }
 #endif
 
@@ -603,6 +800,9 @@ bool QSerialPortPrivate::setCustomBaudRate(qint32 baudRate, QSerialPort::Directi
         return false;
     }
 
+    customBaudRateMayBeSet = true;
+    cachedTermiosValid = false;
+
     struct termios2 tio2;
 
     if (::ioctl(descriptor, TCGETS2, &tio2) != -1) {
@@ -626,7 +826,7 @@ bool QSerialPortPrivate::setCustomBaudRate(qint32 baudRate, QSerialPort::Directi
     }
 
     serial.flags &= ~ASYNC_SPD_MASK;
-    serial.flags |= (ASYNC_SPD_CUST /* | ASYNC_LOW_LATENCY*/);
+    serial.flags |= ASYNC_SPD_CUST;
     serial.custom_divisor = serial.baud_base / baudRate;
 
     if (serial.custom_divisor == 0) {
@@ -661,6 +861,9 @@ bool QSerialPortPrivate::setCustomBaudRate(qint32 baudRate, QSerialPort::Directi
     }
 
 #if defined(MAC_OS_X_VERSION_10_4) && (MAC_OS_X_VERSION_MIN_REQUIRED >= MAC_OS_X_VERSION_10_4)
+    // The speed set this way shows up in the termios settings.
+    cachedTermiosValid = false;
+
     if (::ioctl(descriptor, IOSSIOSPEED, &baudRate) == -1) {
         setError(getSystemError());
         return false;
@@ -757,34 +960,303 @@ bool QSerialPortPrivate::setFlowControl(QSerialPort::FlowControl flowControl)
     return setTermios(&tio);
 }
 
+bool QSerialPortPrivate::applyConfiguration(const QSerialPort::Configuration &configuration)
+{
+    const qint32 inputSetting = settingFromBaudRate(configuration.inputBaudRate);
+    const qint32 outputSetting = settingFromBaudRate(configuration.outputBaudRate);
+    const bool customBaudRate = inputSetting <= 0 || outputSetting <= 0;
+
+#ifdef Q_OS_LINUX
+    // The termios v2 interface carries the speeds as numbers, so that the
+    // line settings and any baud rate, standard or custom, go into one
+    // TCSETS2 call. Standard baud rates only need it to clear a custom one.
+    struct termios2 tio2;
+    if ((customBaudRate || customBaudRateMayBeSet) && ::ioctl(descriptor, TCGETS2, &tio2) != -1) {
+        qt_set_databits(&tio2, configuration.dataBits);
+        qt_set_parity(&tio2, configuration.parity);
+        qt_set_stopbits(&tio2, configuration.stopBits);
+        qt_set_flowcontrol(&tio2, configuration.flowControl);
+
+        tio2.c_cflag &= ~(CBAUD | CIBAUD);
+        tio2.c_cflag |= (outputSetting > 0) ? tcflag_t(outputSetting) : tcflag_t(BOTHER);
+        if (configuration.inputBaudRate != configuration.outputBaudRate)
+            tio2.c_cflag |= ((inputSetting > 0) ? tcflag_t(inputSetting) : tcflag_t(BOTHER)) << IBSHIFT;
+        tio2.c_ispeed = configuration.inputBaudRate;
+        tio2.c_ospeed = configuration.outputBaudRate;
+
+        cachedTermiosValid = false;
+        if (::ioctl(descriptor, TCSETS2, &tio2) == -1) {
+            setError(getSystemError());
+            Q_TRACE(QSerialPortPrivate_setTermios, descriptor, int(tio2.c_iflag),
+                    int(tio2.c_oflag), int(tio2.c_cflag), false);
+            return false;
+        }
+        Q_TRACE(QSerialPortPrivate_setTermios, descriptor, int(tio2.c_iflag),
+                int(tio2.c_oflag), int(tio2.c_cflag), true);
+        customBaudRateMayBeSet = customBaudRate;
+
+        if (termiosVerificationEnabled) {
+            // As in verifyTermios(), with the speeds as numbers.
+            struct termios2 actual;
+            ::memset(&actual, 0, sizeof(actual));
+            if (::ioctl(descriptor, TCGETS2, &actual) == -1) {
+                setError(getSystemError());
+                return false;
+            }
+
+            if (actual.c_iflag != tio2.c_iflag || actual.c_oflag != tio2.c_oflag
+                    || actual.c_cflag != tio2.c_cflag || actual.c_lflag != tio2.c_lflag
+                    || actual.c_ispeed != tio2.c_ispeed || actual.c_ospeed != tio2.c_ospeed) {
+                setError(QSerialPortErrorInfo(QSerialPort::UnsupportedOperationError,
+                                              QSerialPort::tr("The device did not accept all settings")));
+                return false;
+            }
+        }
+        return true;
+    }
+#endif
+
+    if (customBaudRate && configuration.inputBaudRate != configuration.outputBaudRate) {
+        setError(QSerialPortErrorInfo(QSerialPort::UnsupportedOperationError,
+                                      QSerialPort::tr("Cannot set custom speed for one direction")));
+        return false;
+    }
+
+    termios tio;
+    if (!getTermios(&tio))
+        return false;
+
+    qt_set_databits(&tio, configuration.dataBits);
+    qt_set_parity(&tio, configuration.parity);
+    qt_set_stopbits(&tio, configuration.stopBits);
+    qt_set_flowcontrol(&tio, configuration.flowControl);
+
+    if (!customBaudRate
+            && (::cfsetispeed(&tio, inputSetting) < 0 || ::cfsetospeed(&tio, outputSetting) < 0)) {
+        setError(getSystemError());
+        return false;
+    }
+
+    if (!setTermios(&tio))
+        return false;
+
+    // Without termios v2, a custom speed needs its own request.
+    return !customBaudRate || setCustomBaudRate(configuration.outputBaudRate,
+                                                QSerialPort::AllDirections);
+}
+
+#ifdef Q_OS_LINUX
+
+// The latency timer of USB to serial converters such as FTDI is exposed
+// by the usb-serial driver as an attribute of the port device.
+static QString latencyTimerFilePath(const QString &systemLocation)
+{
+    const QString deviceName = QFileInfo(QFileInfo(systemLocation).canonicalFilePath()).fileName();
+    return QLatin1String("/sys/class/tty/") + deviceName + QLatin1String("/device/latency_timer");
+}
+
+static QByteArray readSysfsAttribute(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+    return file.readAll().trimmed();
+}
+
+static bool writeSysfsAttribute(const QString &filePath, const QByteArray &value)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    return file.write(value) == value.size();
+}
+
+#endif
+
+bool QSerialPortPrivate::applyLowLatencyMode()
+{
+#ifdef Q_OS_LINUX
+    struct serial_struct serial;
+    ::memset(&serial, 0, sizeof(serial));
+    if (!(lowLatencyFeatures & QSerialPort::AsyncLowLatencyFeature)
+            && ::ioctl(descriptor, TIOCGSERIAL, &serial) != -1) {
+        restoredAsyncLowLatency = serial.flags & ASYNC_LOW_LATENCY;
+        serial.flags |= ASYNC_LOW_LATENCY;
+        // we don't check on errors because a driver can has not this feature
+        if (restoredAsyncLowLatency || ::ioctl(descriptor, TIOCSSERIAL, &serial) != -1)
+            lowLatencyFeatures |= QSerialPort::AsyncLowLatencyFeature;
+    }
+
+    if (!(lowLatencyFeatures & QSerialPort::LatencyTimerFeature)) {
+        const QString filePath = latencyTimerFilePath(systemLocation);
+        const QByteArray latencyTimer = readSysfsAttribute(filePath);
+        if (!latencyTimer.isEmpty()) {
+            static const QByteArray lowestLatencyTimer("1");
+            if (latencyTimer == lowestLatencyTimer || writeSysfsAttribute(filePath, lowestLatencyTimer)) {
+                restoredLatencyTimer = latencyTimer;
+                lowLatencyFeatures |= QSerialPort::LatencyTimerFeature;
+            }
+        }
+    }
+#endif
+
+    return lowLatencyFeatures != QSerialPort::NoLowLatencyFeature;
+}
+
+void QSerialPortPrivate::restoreLowLatencyMode()
+{
+#ifdef Q_OS_LINUX
+    if ((lowLatencyFeatures & QSerialPort::AsyncLowLatencyFeature) && !restoredAsyncLowLatency) {
+        struct serial_struct serial;
+        ::memset(&serial, 0, sizeof(serial));
+        if (::ioctl(descriptor, TIOCGSERIAL, &serial) != -1) {
+            serial.flags &= ~ASYNC_LOW_LATENCY;
+            ::ioctl(descriptor, TIOCSSERIAL, &serial);
+        }
+    }
+
+    if (lowLatencyFeatures & QSerialPort::LatencyTimerFeature)
+        writeSysfsAttribute(latencyTimerFilePath(systemLocation), restoredLatencyTimer);
+    restoredLatencyTimer.clear();
+#endif
+
+    lowLatencyFeatures = QSerialPort::NoLowLatencyFeature;
+}
+
+void QSerialPortPrivate::startFrameIdleTimer()
+{
+    Q_Q(QSerialPort);
+
+#ifdef Q_OS_LINUX
+    // The timerfd expires at the absolute deadline of the monotonic clock,
+    // which is also the clock behind Qt::PreciseTimer.
+    if (frameIdleDescriptor == -1)
+        frameIdleDescriptor = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    if (frameIdleDescriptor != -1) {
+        if (!frameIdleNotifier)
+            frameIdleNotifier = new FrameIdleNotifier(this, q);
+
+        itimerspec spec = {};
+        spec.it_value.tv_sec = frameDeadline / 1000000000;
+        spec.it_value.tv_nsec = frameDeadline % 1000000000;
+        if (::timerfd_settime(frameIdleDescriptor, TFD_TIMER_ABSTIME, &spec, nullptr) != -1)
+            return;
+    }
+#endif
+
+    if (!frameIdleTimer) {
+        frameIdleTimer = new QTimer(q);
+        frameIdleTimer->setTimerType(Qt::PreciseTimer);
+        frameIdleTimer->setSingleShot(true);
+        QObjectPrivate::connect(frameIdleTimer, &QTimer::timeout, this, &QSerialPortPrivate::frameIdleNotification);
+    }
+
+    const qint64 remaining = frameDeadline - QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+    frameIdleTimer->start(int((qMax(remaining, qint64(0)) + 999999) / 1000000));
+}
+
+void QSerialPortPrivate::stopFrameIdleTimer()
+{
+#ifdef Q_OS_LINUX
+    delete frameIdleNotifier;
+    frameIdleNotifier = nullptr;
+
+    if (frameIdleDescriptor != -1) {
+        qt_safe_close(frameIdleDescriptor);
+        frameIdleDescriptor = -1;
+    }
+#endif
+
+    delete frameIdleTimer;
+    frameIdleTimer = nullptr;
+}
+
 bool QSerialPortPrivate::startAsyncRead()
 {
     setReadNotificationEnabled(true);
+
+    // Data may have been left in the ring while the read buffer was full.
+    if (readThread)
+        readThread->requestNotification();
     return true;
 }
 
-bool QSerialPortPrivate::readNotification()
+bool QSerialPortPrivate::isReadBufferFull() const
 {
-    Q_Q(QSerialPort);
+    return readBufferMaxSize && buffer.size() >= readBufferMaxSize;
+}
 
-    // Always buffered, read data from the port into the read buffer
-    qint64 newBytes = buffer.size();
-    qint64 bytesToRead = QSERIALPORT_BUFFERSIZE;
+qint64 QSerialPortPrivate::readIntoBuffer()
+{
+    qint64 bytesToRead = nextReadChunkSize();
 
-    if (readBufferMaxSize && bytesToRead > (readBufferMaxSize - buffer.size())) {
+    if (readBufferMaxSize && bytesToRead > (readBufferMaxSize - buffer.size()))
         bytesToRead = readBufferMaxSize - buffer.size();
-        if (bytesToRead <= 0) {
-            // Buffer is full. User must read data from the buffer
-            // before we can read more from the port.
-            setReadNotificationEnabled(false);
-            return false;
-        }
-    }
 
     char *ptr = buffer.reserve(bytesToRead);
     const qint64 readBytes = readFromPort(ptr, bytesToRead);
 
     buffer.chop(bytesToRead - qMax(readBytes, qint64(0)));
+    recordReceivedData(readBytes);
+
+    if (readBytes > 0 && readChunkPolicy == QSerialPort::AdaptiveReadChunk)
+        updateAdaptiveReadChunkSize(bytesToRead, readBytes);
+
+    return readBytes;
+}
+
+bool QSerialPortPrivate::startReadThread()
+{
+    std::unique_ptr<QSerialPortReadThread> newReadThread(
+                new QSerialPortReadThread(descriptor, readThreadBufferSize, &statistics));
+    if (!newReadThread->isValid()) {
+        setError(getSystemError());
+        return false;
+    }
+
+    newReadThread->setObjectName(QLatin1String("QSerialPort read thread"));
+    newReadThread->start();
+    readThread = newReadThread.release();
+    return true;
+}
+
+bool QSerialPortPrivate::readFromReadThread()
+{
+    readThread->acknowledgeNotification();
+
+    QSerialPortReadRing &ring = readThread->ring();
+    while (!isReadBufferFull()) {
+        qint64 length = 0;
+        const char *data = ring.readPointer(&length);
+        if (length <= 0)
+            break;
+        if (readBufferMaxSize)
+            length = qMin(length, readBufferMaxSize - buffer.size());
+        ::memcpy(buffer.reserve(length), data, size_t(length));
+        ring.release(length);
+        recordReceivedData(length);
+    }
+    readThread->resumeReading();
+
+    // The thread stops on errors, report them once the data before them
+    // has been delivered.
+    const int errorCode = readThread->errorCode();
+    if (errorCode != 0 && ring.isEmpty()) {
+        QSerialPortErrorInfo error = getSystemError(errorCode);
+        if (error.errorCode != QSerialPort::ResourceError)
+            error.errorCode = QSerialPort::ReadError;
+        setReadNotificationEnabled(false);
+        setError(error);
+        return false;
+    }
+
+    return true;
+}
+
+bool QSerialPortPrivate::readFromPortIntoBuffer()
+{
+    const qint64 readBytes = readIntoBuffer();
 
     if (readBytes <= 0) {
         QSerialPortErrorInfo error = getSystemError();
@@ -796,27 +1268,296 @@ bool QSerialPortPrivate::readNotification()
         return false;
     }
 
-    newBytes = buffer.size() - newBytes;
+    if (readBatchingEnabled || group || drainingRead) {
+        // Keep reading until the driver runs dry or the budget is spent,
+        // so that a single readyRead() covers the whole batch. Errors are
+        // left for the next notification to report. A group watches the
+        // descriptor edge-triggered, and waitForReadyRead() has nothing
+        // else to do, so the batch is not limited there.
+        QElapsedTimer batchTimer;
+        if (readBatchTimeLimit > 0)
+            batchTimer.start();
+
+        const bool drain = group != nullptr || drainingRead;
+        qint64 batchBytes = readBytes;
+        ++batchedReadCount;
+        ++readBatchCount;
+
+        while ((drain || readBatchByteLimit <= 0 || batchBytes < readBatchByteLimit)
+               && !isReadBufferFull()
+               && (drain || readBatchTimeLimit <= 0
+                   || batchTimer.nsecsElapsed() < qint64(readBatchTimeLimit) * 1000)) {
+            const qint64 moreBytes = readIntoBuffer();
+            ++batchedReadCount;
+            if (moreBytes <= 0)
+                break;
+            batchBytes += moreBytes;
+        }
+    }
+
+    return true;
+}
+
+#if QT_CONFIG(liburing)
+bool QSerialPortPrivate::startIoUringRead()
+{
+    // The amount of queued data is unknown when the read is submitted,
+    // so the available read chunk policy reads full chunks.
+    qint64 bytesToRead = readChunkPolicy == QSerialPort::AvailableReadChunk
+            ? readChunkSize : nextReadChunkSize();
+
+    if (readBufferMaxSize && bytesToRead > (readBufferMaxSize - buffer.size()))
+        bytesToRead = readBufferMaxSize - buffer.size();
+    if (bytesToRead <= 0)
+        return true;
+
+    if (ioUringReadBuffer.size() < bytesToRead)
+        ioUringReadBuffer.resize(bytesToRead);
+
+    if (!ioUring->submitRead(this, ioUringReadBuffer.data(), bytesToRead)) {
+        setError(getSystemError());
+        return false;
+    }
+
+    ioUringReadRequested = bytesToRead;
+    ioUringReadPollError = 0;
+    ioUringReadStarted = true;
+    return true;
+}
+
+bool QSerialPortPrivate::startIoUringWrite()
+{
+    // Continue with the blocks left over by a partial write, then move
+    // further blocks out of the write buffer. The kernel writes straight
+    // from their memory.
+    int vectorCount = 0;
+    const int maximumVectorCount = int(sizeof(ioUringWriteVectors) / sizeof(iovec));
+
+    for (const QByteArray &chunk : qAsConst(ioUringWriteChunks)) {
+        const qint64 offset = vectorCount == 0 ? ioUringWriteOffset : 0;
+        ioUringWriteVectors[vectorCount].iov_base = const_cast<char *>(chunk.constData()) + offset;
+        ioUringWriteVectors[vectorCount].iov_len = size_t(chunk.size() - offset);
+        ++vectorCount;
+    }
+
+    while (vectorCount < maximumVectorCount && !writeBuffer.isEmpty()) {
+        const QByteArray chunk = writeBuffer.read();
+        ioUringWriteVectors[vectorCount].iov_base = const_cast<char *>(chunk.constData());
+        ioUringWriteVectors[vectorCount].iov_len = size_t(chunk.size());
+        ioUringWriteChunks.append(chunk);
+        ++vectorCount;
+    }
+
+    if (vectorCount == 0)
+        return true;
+
+    if (!ioUring->submitWrite(this, ioUringWriteVectors, vectorCount)) {
+        QSerialPortErrorInfo error = getSystemError();
+        error.errorCode = QSerialPort::WriteError;
+        setError(error);
+        return false;
+    }
+
+    ioUringWritePollError = 0;
+    writeSequenceStarted = true;
+
+    if (writePolicy == QSerialPort::ImmediateWrite)
+        ioUring->submit();
+    return true;
+}
+
+void QSerialPortPrivate::completeIoUringOperation(int type, int result)
+{
+    switch (type) {
+    case QSerialPortIoUring::ReadPollOperation:
+        // A failed poll cancels the read linked to it.
+        if (result < 0 && result != -ECANCELED)
+            ioUringReadPollError = -result;
+        break;
+    case QSerialPortIoUring::ReadOperation:
+        completeIoUringRead(result);
+        break;
+    case QSerialPortIoUring::WritePollOperation:
+        if (result < 0 && result != -ECANCELED)
+            ioUringWritePollError = -result;
+        break;
+    case QSerialPortIoUring::WriteOperation:
+        completeIoUringWrite(result);
+        break;
+    }
+}
+
+void QSerialPortPrivate::completeIoUringRead(int result)
+{
+    ioUringReadStarted = false;
+
+    if (result == -ECANCELED && ioUringReadPollError != 0)
+        result = -ioUringReadPollError;
+
+    if (result == 0 || (result < 0 && result != -EAGAIN && result != -ECANCELED)) {
+        // The poll reported a hang-up if there is nothing to read.
+        QSerialPortErrorInfo error = getSystemError(result == 0 ? EIO : -result);
+        if (error.errorCode != QSerialPort::ResourceError)
+            error.errorCode = QSerialPort::ReadError;
+        ioUringReadEnabled = false;
+        setError(error);
+        return;
+    }
+
+    if (result > 0 || result == -EAGAIN)
+        statistics.recordRead(qMax(result, 0));
+
+    if (result > 0) {
+        // The read buffer cannot lend memory to a read in flight, because
+        // all of its space counts as readable. So the kernel reads into a
+        // separate array. If the read filled most of it, the array becomes
+        // a block of the read buffer as it is, and the next read gets a
+        // new one; smaller reads are copied, so that the read buffer does
+        // not keep mostly empty blocks alive.
+        if (result >= ioUringReadBuffer.size() / 2) {
+            ioUringReadBuffer.truncate(result);
+            buffer.append(ioUringReadBuffer);
+            ioUringReadBuffer = QByteArray();
+        } else {
+            buffer.append(ioUringReadBuffer.constData(), result);
+        }
+        recordReceivedData(result);
+        if (readChunkPolicy == QSerialPort::AdaptiveReadChunk)
+            updateAdaptiveReadChunkSize(ioUringReadRequested, result);
+        ioUringReadCompleted = true;
+    }
+
+    // Keep a read submitted, unless the user has to make room first.
+    if (ioUringReadEnabled && !isReadBufferFull())
+        startIoUringRead();
+    else
+        ioUringReadEnabled = false;
+
+    if (result > 0)
+        deliverReadData(result);
+}
+
+void QSerialPortPrivate::completeIoUringWrite(int result)
+{
+    writeSequenceStarted = false;
+
+    if (result == -ECANCELED && ioUringWritePollError != 0)
+        result = -ioUringWritePollError;
+
+    if (result < 0 && result != -EAGAIN && result != -ECANCELED) {
+        QSerialPortErrorInfo error = getSystemError(-result);
+        if (error.errorCode != QSerialPort::ResourceError)
+            error.errorCode = QSerialPort::WriteError;
+        setError(error);
+        return;
+    }
+
+    if (result > 0) {
+        statistics.recordWrite(result);
+        qint64 remaining = result;
+        while (remaining > 0 && !ioUringWriteChunks.isEmpty()) {
+            const qint64 chunkBytes = ioUringWriteChunks.constFirst().size() - ioUringWriteOffset;
+            if (remaining < chunkBytes) {
+                ioUringWriteOffset += remaining;
+                break;
+            }
+            remaining -= chunkBytes;
+            ioUringWriteChunks.removeFirst();
+            ioUringWriteOffset = 0;
+        }
+        pendingBytesWritten += result;
+        ioUringWriteCompleted = true;
+    }
+
+    // Emits bytesWritten() and moves on with the write buffer.
+    completeAsyncWrite();
+
+    if (ioUring && !writeSequenceStarted && !ioUringWriteChunks.isEmpty())
+        startIoUringWrite();
+}
+
+bool QSerialPortPrivate::waitForIoUring(int msecs, bool *completed)
+{
+    QDeadlineTimer deadline(msecs);
+    *completed = false;
+
+    do {
+        if (!ioUring->waitForCompletions(deadline))
+            break;
+        if (*completed) {
+            *completed = false;
+            return true;
+        }
+    } while (ioUring && !deadline.hasExpired());
+
+    if (ioUring)
+        setError(QSerialPortErrorInfo(QSerialPort::TimeoutError));
+    return false;
+}
+#endif
+
+bool QSerialPortPrivate::readNotification()
+{
+    // Always buffered, read data from the port into the read buffer
+    qint64 newBytes = buffer.size();
+    Q_TRACE(QSerialPortPrivate_readNotification_entry, descriptor, newBytes);
+
+    if (isReadBufferFull()) {
+        // Buffer is full. User must read data from the buffer
+        // before we can read more from the port.
+        setReadNotificationEnabled(false);
+        return false;
+    }
+
+    if (readThread) {
+        if (!readFromReadThread())
+            return false;
+    } else if (!readFromPortIntoBuffer()) {
+        return false;
+    }
+
+    Q_TRACE(QSerialPortPrivate_readNotification_exit, descriptor, buffer.size() - newBytes);
+    deliverReadData(buffer.size() - newBytes);
+    return true;
+}
+
+void QSerialPortPrivate::deliverReadData(qint64 newBytes)
+{
+    Q_Q(QSerialPort);
+
+    if (frameIdleGap > 0) {
+        // The data is delivered by frameReceived() once the line is idle.
+        if (newBytes > 0)
+            takeFrameData();
+        return;
+    }
 
     // only emit readyRead() when not recursing, and only if there is data available
     const bool hasData = newBytes > 0;
 
     if (!emittedReadyRead && hasData) {
         emittedReadyRead = true;
+        statistics.recordReadyRead();
         emit q->readyRead();
         emittedReadyRead = false;
     }
-
-    return true;
 }
 
 bool QSerialPortPrivate::startAsyncWrite()
 {
+#if QT_CONFIG(liburing)
+    if (ioUring) {
+        if ((writeBuffer.isEmpty() && ioUringWriteChunks.isEmpty()) || writeSequenceStarted)
+            return true;
+        return startIoUringWrite();
+    }
+#endif
+
     if (writeBuffer.isEmpty() || writeSequenceStarted)
         return true;
 
-    // Attempt to write it all in one chunk.
-    qint64 written = writeToPort(writeBuffer.readPointer(), writeBuffer.nextDataBlockSize());
+    // Attempt to write it all in one go.
+    qint64 written = writeBufferToPort();
     if (written < 0) {
         QSerialPortErrorInfo error = getSystemError();
         if (error.errorCode != QSerialPort::ResourceError)
@@ -825,6 +1566,7 @@ bool QSerialPortPrivate::startAsyncWrite()
         return false;
     }
 
+    Q_TRACE(QSerialPortPrivate_startAsyncWrite, descriptor, writeBuffer.size(), written);
     writeBuffer.free(written);
     pendingBytesWritten += written;
     writeSequenceStarted = true;
@@ -838,9 +1580,13 @@ bool QSerialPortPrivate::completeAsyncWrite()
 {
     Q_Q(QSerialPort);
 
+    Q_TRACE(QSerialPortPrivate_completeAsyncWrite, descriptor, pendingBytesWritten,
+            writeBuffer.size());
+
     if (pendingBytesWritten > 0) {
         if (!emittedBytesWritten) {
             emittedBytesWritten = true;
+            statistics.recordBytesWritten();
             emit q->bytesWritten(pendingBytesWritten);
             pendingBytesWritten = 0;
             emittedBytesWritten = false;
@@ -859,39 +1605,125 @@ bool QSerialPortPrivate::completeAsyncWrite()
 
 inline bool QSerialPortPrivate::initialize(QIODevice::OpenMode mode)
 {
+    exclusiveModeSet = false;
 #ifdef TIOCEXCL
-    if (::ioctl(descriptor, TIOCEXCL) == -1)
-        setError(getSystemError());
+    if (lockingStrategy != QSerialPort::NoLocking) {
+        if (::ioctl(descriptor, TIOCEXCL) == -1)
+            setError(getSystemError());
+        else
+            exclusiveModeSet = true;
+    }
 #endif
 
+    // Nothing is known about the settings of a port that was just opened.
+    cachedTermiosValid = false;
+    termiosVerificationEnabled = !qEnvironmentVariableIsEmpty("QT_SERIALPORT_VERIFY_SETTINGS");
+
     termios tio;
     if (!getTermios(&tio))
         return false;
 
     restoredTermios = tio;
 
+#ifdef Q_OS_LINUX
+    // A custom baud rate left behind shows up as BOTHER, or as B38400 if it
+    // was set through serial_struct.
+    const tcflag_t speedBits = tio.c_cflag & CBAUD;
+    customBaudRateMayBeSet = speedBits == BOTHER || speedBits == B38400;
+#endif
+
     qt_set_common_props(&tio, mode);
     qt_set_databits(&tio, dataBits);
     qt_set_parity(&tio, parity);
     qt_set_stopbits(&tio, stopBits);
     qt_set_flowcontrol(&tio, flowControl);
 
+    // Standard baud rates go out with the line settings in one tcsetattr().
+    const qint32 inputSetting = settingFromBaudRate(inputBaudRate);
+    const qint32 outputSetting = settingFromBaudRate(outputBaudRate);
+    bool baudRateSet = inputSetting > 0 && outputSetting > 0;
+#ifdef Q_OS_LINUX
+    baudRateSet = baudRateSet && !customBaudRateMayBeSet;
+#endif
+    if (baudRateSet
+            && (::cfsetispeed(&tio, inputSetting) < 0 || ::cfsetospeed(&tio, outputSetting) < 0)) {
+        setError(getSystemError());
+        return false;
+    }
+
     if (!setTermios(&tio))
         return false;
 
-    if (!setBaudRate())
+    if (!baudRateSet && !setBaudRate())
         return false;
 
-    if (mode & QIODevice::ReadOnly)
+    if (lowLatencyMode)
+        applyLowLatencyMode();
+
+#if QT_CONFIG(liburing)
+    if (!group && !readThreadEnabled && qEnvironmentVariableIsEmpty("QT_SERIALPORT_NO_IO_URING"))
+        ioUring = QSerialPortIoUring::acquire();
+#endif
+
+    if (mode & QIODevice::ReadOnly) {
+        if (readThreadEnabled && !group && !startReadThread())
+            return false;
         setReadNotificationEnabled(true);
+    }
 
     return true;
 }
 
 qint64 QSerialPortPrivate::writeData(const char *data, qint64 maxSize)
 {
-    writeBuffer.append(data, maxSize);
-    if (!writeBuffer.isEmpty() && !isWriteNotificationEnabled())
+    Q_Q(QSerialPort);
+
+    qint64 bytesToBuffer = maxSize;
+
+    if (writePolicy == QSerialPort::ImmediateWrite && writeBuffer.isEmpty() && !ioUring) {
+        // Nothing is queued, so the data can go out right away without
+        // breaking the order. The bytesWritten() signal is still emitted
+        // from the write notification.
+        const qint64 written = writeToPort(data, maxSize);
+        if (written < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                QSerialPortErrorInfo error = getSystemError();
+                if (error.errorCode != QSerialPort::ResourceError)
+                    error.errorCode = QSerialPort::WriteError;
+                setError(error);
+                return -1;
+            }
+        } else if (written > 0) {
+            pendingBytesWritten += written;
+            writeSequenceStarted = true;
+            data += written;
+            bytesToBuffer -= written;
+        }
+    }
+
+    if (bytesToBuffer > 0)
+        writeBuffer.append(data, bytesToBuffer);
+
+    if (writePolicy == QSerialPort::CoalescedWrite && !writeSequenceStarted
+            && writeBuffer.size() < writeCoalescingByteLimit) {
+        // Hold the data back for a while, so that following writes
+        // can be sent together with it.
+        if (!writeCoalescingTimer) {
+            writeCoalescingTimer = new QTimer(q);
+            writeCoalescingTimer->setSingleShot(true);
+            writeCoalescingTimer->setTimerType(Qt::PreciseTimer);
+            QObjectPrivate::connect(writeCoalescingTimer, &QTimer::timeout,
+                                    this, &QSerialPortPrivate::startAsyncWrite);
+        }
+        if (!writeCoalescingTimer->isActive())
+            writeCoalescingTimer->start(writeCoalescingInterval());
+        return maxSize;
+    }
+
+    if (writeCoalescingTimer)
+        writeCoalescingTimer->stop();
+
+    if ((!writeBuffer.isEmpty() || writeSequenceStarted) && !isWriteNotificationEnabled())
         setWriteNotificationEnabled(true);
     return maxSize;
 }
@@ -900,18 +1732,65 @@ bool QSerialPortPrivate::setTermios(const termios *tio)
 {
     if (::tcsetattr(descriptor, TCSANOW, tio) == -1) {
         setError(getSystemError());
+        // The driver may have taken a part of the settings.
+        cachedTermiosValid = false;
+        Q_TRACE(QSerialPortPrivate_setTermios, descriptor, int(tio->c_iflag),
+                int(tio->c_oflag), int(tio->c_cflag), false);
         return false;
     }
-    return true;
+    Q_TRACE(QSerialPortPrivate_setTermios, descriptor, int(tio->c_iflag),
+            int(tio->c_oflag), int(tio->c_cflag), true);
+
+    if (tio != &cachedTermios)
+        cachedTermios = *tio;
+    cachedTermiosValid = true;
+
+    return !termiosVerificationEnabled || verifyTermios();
 }
 
 bool QSerialPortPrivate::getTermios(termios *tio)
 {
-    ::memset(tio, 0, sizeof(termios));
-    if (::tcgetattr(descriptor, tio) == -1) {
+    if (cachedTermiosValid) {
+        *tio = cachedTermios;
+        return true;
+    }
+
+    ::memset(&cachedTermios, 0, sizeof(termios));
+    if (::tcgetattr(descriptor, &cachedTermios) == -1) {
+        setError(getSystemError());
+        return false;
+    }
+    cachedTermiosValid = true;
+    *tio = cachedTermios;
+    return true;
+}
+
+// tcsetattr() succeeds as soon as the driver took any of the settings, so
+// the verification reads them back and reports the ones that were dropped.
+bool QSerialPortPrivate::verifyTermios()
+{
+    termios actual;
+    ::memset(&actual, 0, sizeof(termios));
+    if (::tcgetattr(descriptor, &actual) == -1) {
+        cachedTermiosValid = false;
         setError(getSystemError());
         return false;
     }
+
+    const bool applied = actual.c_iflag == cachedTermios.c_iflag
+            && actual.c_oflag == cachedTermios.c_oflag
+            && actual.c_cflag == cachedTermios.c_cflag
+            && actual.c_lflag == cachedTermios.c_lflag
+            && ::cfgetospeed(&actual) == ::cfgetospeed(&cachedTermios);
+
+    // Keep what the driver actually uses.
+    cachedTermios = actual;
+
+    if (!applied) {
+        setError(QSerialPortErrorInfo(QSerialPort::UnsupportedOperationError,
+                                      QSerialPort::tr("The device did not accept all settings")));
+        return false;
+    }
     return true;
 }
 
@@ -979,8 +1858,33 @@ QSerialPortErrorInfo QSerialPortPrivate::getSystemError(int systemErrorCode) con
     return error;
 }
 
+qint64 QSerialPortPrivate::queuedBytesCount(QSerialPort::Direction direction) const
+{
+    int queuedBytes = 0;
+    if (direction == QSerialPort::Input) {
+        if (::ioctl(descriptor, FIONREAD, &queuedBytes) == -1)
+            return -1;
+    } else if (direction == QSerialPort::Output) {
+#ifdef TIOCOUTQ
+        if (::ioctl(descriptor, TIOCOUTQ, &queuedBytes) == -1)
+            return -1;
+#else
+        return -1;
+#endif
+    } else {
+        return -1;
+    }
+    return queuedBytes;
+}
+
 bool QSerialPortPrivate::isReadNotificationEnabled() const
 {
+#if QT_CONFIG(liburing)
+    if (ioUring)
+        return ioUringReadEnabled;
+#endif
+    if (group)
+        return groupReadNotificationEnabled;
     return readNotifier && readNotifier->isEnabled();
 }
 
@@ -988,7 +1892,22 @@ void QSerialPortPrivate::setReadNotificationEnabled(bool enable)
 {
     Q_Q(QSerialPort);
 
-    if (readNotifier) {
+#if QT_CONFIG(liburing)
+    if (ioUring) {
+        // The ring keeps a read submitted for as long as reading is enabled.
+        ioUringReadEnabled = enable;
+        if (enable && !ioUringReadStarted)
+            startIoUringRead();
+        return;
+    }
+#endif
+
+    if (group) {
+        if (groupReadNotificationEnabled != enable) {
+            groupReadNotificationEnabled = enable;
+            group->updatePort(this);
+        }
+    } else if (readNotifier) {
         readNotifier->setEnabled(enable);
     } else if (enable) {
         readNotifier = new ReadNotifier(this, q);
@@ -998,6 +1917,10 @@ void QSerialPortPrivate::setReadNotificationEnabled(bool enable)
 
 bool QSerialPortPrivate::isWriteNotificationEnabled() const
 {
+    if (ioUring)
+        return writeSequenceStarted;
+    if (group)
+        return groupWriteNotificationEnabled;
     return writeNotifier && writeNotifier->isEnabled();
 }
 
@@ -1005,7 +1928,19 @@ void QSerialPortPrivate::setWriteNotificationEnabled(bool enable)
 {
     Q_Q(QSerialPort);
 
-    if (writeNotifier) {
+    if (ioUring) {
+        // Writes complete through the ring, there is nothing to wait for.
+        if (enable)
+            startAsyncWrite();
+        return;
+    }
+
+    if (group) {
+        if (groupWriteNotificationEnabled != enable) {
+            groupWriteNotificationEnabled = enable;
+            group->updatePort(this);
+        }
+    } else if (writeNotifier) {
         writeNotifier->setEnabled(enable);
     } else if (enable) {
         writeNotifier = new WriteNotifier(this, q);
@@ -1013,22 +1948,198 @@ void QSerialPortPrivate::setWriteNotificationEnabled(bool enable)
     }
 }
 
+#ifdef Q_OS_LINUX
+enum WaitDescriptorKey {
+    WaitPortKey,
+    WaitReadThreadKey,
+    WaitTimerKey
+};
+
+static bool updateWaitEvents(int waitDescriptor, int descriptor, WaitDescriptorKey key,
+                             quint32 events, quint32 *registeredEvents)
+{
+    if (events == *registeredEvents)
+        return true;
+
+    epoll_event event = {};
+    event.events = events;
+    event.data.u32 = key;
+    if (::epoll_ctl(waitDescriptor, EPOLL_CTL_MOD, descriptor, &event) == -1)
+        return false;
+
+    *registeredEvents = events;
+    return true;
+}
+
+bool QSerialPortPrivate::openWaitDescriptor()
+{
+    waitDescriptor = ::epoll_create1(EPOLL_CLOEXEC);
+    if (waitDescriptor == -1)
+        return false;
+
+    waitTimerDescriptor = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (waitTimerDescriptor == -1) {
+        closeWaitDescriptor();
+        return false;
+    }
+
+    // Everything is registered once, later waits only modify the events.
+    const struct {
+        int descriptor;
+        WaitDescriptorKey key;
+        quint32 events;
+    } registrations[] = {
+        { descriptor, WaitPortKey, 0 },
+        { readThread ? readThread->notificationDescriptor() : -1, WaitReadThreadKey, 0 },
+        { waitTimerDescriptor, WaitTimerKey, EPOLLIN }
+    };
+
+    for (const auto &registration : registrations) {
+        if (registration.descriptor == -1)
+            continue;
+        epoll_event event = {};
+        event.events = registration.events;
+        event.data.u32 = registration.key;
+        if (::epoll_ctl(waitDescriptor, EPOLL_CTL_ADD, registration.descriptor, &event) == -1) {
+            closeWaitDescriptor();
+            return false;
+        }
+    }
+
+    waitPortEvents = 0;
+    waitReadThreadEvents = 0;
+    waitDeadline = std::numeric_limits<qint64>::max();
+    return true;
+}
+
+void QSerialPortPrivate::closeWaitDescriptor()
+{
+    if (waitTimerDescriptor != -1) {
+        qt_safe_close(waitTimerDescriptor);
+        waitTimerDescriptor = -1;
+    }
+
+    if (waitDescriptor != -1) {
+        qt_safe_close(waitDescriptor);
+        waitDescriptor = -1;
+    }
+}
+
+bool QSerialPortPrivate::waitForEvents(bool *selectForRead, bool *selectForWrite,
+                                       bool checkRead, bool checkWrite,
+                                       QDeadlineTimer deadline)
+{
+    // With a read thread, incoming data is signaled by its notification
+    // pipe instead of the port.
+    const quint32 portEvents = (checkWrite ? quint32(EPOLLOUT) : 0)
+            | (checkRead && !readThread ? quint32(EPOLLIN) : 0);
+    const quint32 readThreadEvents = checkRead && readThread ? quint32(EPOLLIN) : 0;
+
+    if (!updateWaitEvents(waitDescriptor, descriptor, WaitPortKey, portEvents, &waitPortEvents)
+            || (readThread && !updateWaitEvents(waitDescriptor, readThread->notificationDescriptor(),
+                                                WaitReadThreadKey, readThreadEvents,
+                                                &waitReadThreadEvents))) {
+        setError(getSystemError());
+        return false;
+    }
+
+    // The timer expires at the absolute deadline, so the loops of the
+    // waitFor*() functions arm it once rather than recomputing the
+    // remaining time on every pass.
+    const qint64 deadlineNSecs = deadline.deadlineNSecs();
+    if (deadlineNSecs != waitDeadline) {
+        itimerspec spec = {};
+        if (!deadline.isForever()) {
+            // An all zero expiry would disarm the timer.
+            const qint64 expiry = qMax(deadlineNSecs, qint64(1));
+            spec.it_value.tv_sec = expiry / 1000000000;
+            spec.it_value.tv_nsec = expiry % 1000000000;
+        }
+        if (::timerfd_settime(waitTimerDescriptor, TFD_TIMER_ABSTIME, &spec, nullptr) == -1) {
+            setError(getSystemError());
+            return false;
+        }
+        waitDeadline = deadlineNSecs;
+    }
+
+    epoll_event events[3];
+    int ret;
+    EINTR_LOOP(ret, ::epoll_wait(waitDescriptor, events, 3, -1));
+    if (ret < 0) {
+        setError(getSystemError());
+        return false;
+    }
+
+    bool timedOut = false;
+    for (int i = 0; i < ret; ++i) {
+        switch (events[i].data.u32) {
+        case WaitPortKey:
+            *selectForWrite = (events[i].events & EPOLLOUT) != 0;
+            if (!readThread)
+                *selectForRead = (events[i].events & EPOLLIN) != 0;
+            break;
+        case WaitReadThreadKey:
+            *selectForRead = (events[i].events & EPOLLIN) != 0;
+            break;
+        case WaitTimerKey: {
+            quint64 expirations = 0;
+            qt_safe_read(waitTimerDescriptor, &expirations, sizeof(expirations));
+            // Expired timers are disarmed.
+            waitDeadline = std::numeric_limits<qint64>::max();
+            timedOut = true;
+            break;
+        }
+        }
+    }
+
+    if (timedOut && !*selectForRead && !*selectForWrite) {
+        setError(QSerialPortErrorInfo(QSerialPort::TimeoutError));
+        return false;
+    }
+    return true;
+}
+#endif
+
 bool QSerialPortPrivate::waitForReadOrWrite(bool *selectForRead, bool *selectForWrite,
                                            bool checkRead, bool checkWrite,
-                                           int msecs)
+                                           QDeadlineTimer deadline)
+{
+    Q_TRACE(QSerialPortPrivate_waitForReadOrWrite_entry, descriptor, checkRead, checkWrite,
+            deadline.remainingTimeNSecs());
+    const bool success = pollForReadOrWrite(selectForRead, selectForWrite,
+                                            checkRead, checkWrite, deadline);
+    Q_TRACE(QSerialPortPrivate_waitForReadOrWrite_exit, descriptor, success,
+            success && *selectForRead, success && *selectForWrite);
+    return success;
+}
+
+bool QSerialPortPrivate::pollForReadOrWrite(bool *selectForRead, bool *selectForWrite,
+                                           bool checkRead, bool checkWrite,
+                                           QDeadlineTimer deadline)
 {
     Q_ASSERT(selectForRead);
     Q_ASSERT(selectForWrite);
 
-    pollfd pfd = qt_make_pollfd(descriptor, 0);
+#ifdef Q_OS_LINUX
+    if (waitDescriptor != -1 || openWaitDescriptor())
+        return waitForEvents(selectForRead, selectForWrite, checkRead, checkWrite, deadline);
+#endif
+
+    // With a read thread, incoming data is signaled by its notification
+    // pipe instead of the port.
+    pollfd pfds[2] = {
+        qt_make_pollfd(descriptor, 0),
+        qt_make_pollfd(readThread ? readThread->notificationDescriptor() : -1, 0)
+    };
+    pollfd &readPfd = readThread ? pfds[1] : pfds[0];
 
     if (checkRead)
-        pfd.events |= POLLIN;
+        readPfd.events |= POLLIN;
 
     if (checkWrite)
-        pfd.events |= POLLOUT;
+        pfds[0].events |= POLLOUT;
 
-    const int ret = qt_poll_msecs(&pfd, 1, msecs);
+    const int ret = qt_poll_msecs(pfds, readThread ? 2 : 1, deadline.remainingTime());
     if (ret < 0) {
         setError(getSystemError());
         return false;
@@ -1037,19 +2148,22 @@ bool QSerialPortPrivate::waitForReadOrWrite(bool *selectForRead, bool *selectFor
         setError(QSerialPortErrorInfo(QSerialPort::TimeoutError));
         return false;
     }
-    if (pfd.revents & POLLNVAL) {
+    if ((pfds[0].revents | readPfd.revents) & POLLNVAL) {
         setError(getSystemError(EBADF));
         return false;
     }
 
-    *selectForWrite = ((pfd.revents & POLLOUT) != 0);
-    *selectForRead = ((pfd.revents & POLLIN) != 0);
+    *selectForWrite = ((pfds[0].revents & POLLOUT) != 0);
+    *selectForRead = ((readPfd.revents & POLLIN) != 0);
     return true;
 }
 
 qint64 QSerialPortPrivate::readFromPort(char *data, qint64 maxSize)
 {
-    return qt_safe_read(descriptor, data, maxSize);
+    const qint64 readBytes = qt_safe_read(descriptor, data, maxSize);
+    if (readBytes >= 0 || errno == EAGAIN || errno == EWOULDBLOCK)
+        statistics.recordRead(readBytes);
+    return readBytes;
 }
 
 qint64 QSerialPortPrivate::writeToPort(const char *data, qint64 maxSize)
@@ -1066,6 +2180,44 @@ qint64 QSerialPortPrivate::writeToPort(const char *data, qint64 maxSize)
     }
 #endif
 
+    statistics.recordWrite(bytesWritten);
+    return bytesWritten;
+}
+
+// The maximum number of write buffer blocks passed to a single writev() call.
+// POSIX guarantees that IOV_MAX is at least 16.
+static const int maximumWriteVectorSize = 16;
+
+qint64 QSerialPortPrivate::writeBufferToPort()
+{
+#if !defined(CMSPAR)
+    // Parity emulation has to look at every character.
+    if (parity == QSerialPort::MarkParity || parity == QSerialPort::SpaceParity)
+        return writeToPort(writeBuffer.readPointer(), writeBuffer.nextDataBlockSize());
+#endif
+
+    iovec vector[maximumWriteVectorSize];
+    int vectorSize = 0;
+    const qint64 bufferSize = writeBuffer.size();
+    qint64 position = 0;
+
+    while (vectorSize < maximumWriteVectorSize && position < bufferSize) {
+        qint64 length = 0;
+        const char *data = writeBuffer.readPointerAtPosition(position, length);
+        if (!data || length <= 0)
+            break;
+        vector[vectorSize].iov_base = const_cast<char *>(data);
+        vector[vectorSize].iov_len = size_t(length);
+        ++vectorSize;
+        position += length;
+    }
+
+    if (vectorSize <= 1)
+        return writeToPort(writeBuffer.readPointer(), writeBuffer.nextDataBlockSize());
+
+    qint64 bytesWritten;
+    EINTR_LOOP(bytesWritten, ::writev(descriptor, vector, vectorSize));
+    statistics.recordWrite(bytesWritten);
     return bytesWritten;
 }
 
@@ -1079,6 +2231,29 @@ static inline bool evenParity(quint8 c)
     return c & 1;       //(c7 ^ c3)(c5 ^ c1)(c6 ^ c2)(c4 ^ c0)
 }
 
+void QSerialPortPrivate::takeOverPendingInput()
+{
+    Q_Q(QSerialPort);
+
+    // The read thread and io_uring keep reading on their own.
+    if (readThread || ioUring || !(q->openMode() & QIODevice::ReadOnly))
+        return;
+
+    const qint64 oldSize = buffer.size();
+    while (!isReadBufferFull() && queuedBytesCount(QSerialPort::Input) > 0) {
+        if (readIntoBuffer() <= 0)
+            break;
+    }
+
+    // The read notifier does not fire for data that is already buffered.
+    const qint64 newBytes = buffer.size() - oldSize;
+    if (newBytes > 0) {
+        QMetaObject::invokeMethod(q, [this, newBytes]() {
+            deliverReadData(newBytes);
+        }, Qt::QueuedConnection);
+    }
+}
+
 qint64 QSerialPortPrivate::writePerChar(const char *data, qint64 maxSize)
 {
     termios tio;
@@ -1087,27 +2262,41 @@ qint64 QSerialPortPrivate::writePerChar(const char *data, qint64 maxSize)
 
     qint64 ret = 0;
     quint8 const charMask = (0xFF >> (8 - dataBits));
+    const bool mark = parity == QSerialPort::MarkParity;
 
-    while (ret < maxSize) {
+    // True if the character needs odd parity to get the mark or space bit.
+    auto needsOddParity = [charMask, mark](char c) {
+        return evenParity(c & charMask) != mark;
+    };
 
-        bool par = evenParity(*data & charMask);
-        // False if need EVEN, true if need ODD.
-        par ^= parity == QSerialPort::MarkParity;
-        if (par ^ (tio.c_cflag & PARODD)) { // Need switch parity mode?
+    while (ret < maxSize) {
+        // Send the longest run of characters that need the same parity
+        // with a single write.
+        const bool odd = needsOddParity(data[ret]);
+        qint64 runLength = 1;
+        while (ret + runLength < maxSize && needsOddParity(data[ret + runLength]) == odd)
+            ++runLength;
+
+        if (odd != bool(tio.c_cflag & PARODD)) {
+            // The characters sent before have to leave with their parity.
+            if (::tcdrain(descriptor) == -1) {
+                setError(getSystemError());
+                break;
+            }
+            // Some drivers reset their FIFOs when reconfigured, so take
+            // over what has been received so far.
+            takeOverPendingInput();
             tio.c_cflag ^= PARODD;
-            flush(); //force sending already buffered data, because setTermios(&tio); cleares buffers
-            //todo: add receiving buffered data!!!
             if (!setTermios(&tio))
                 break;
         }
 
-        int r = qt_safe_write(descriptor, data, 1);
+        const qint64 r = qt_safe_write(descriptor, data + ret, runLength);
         if (r < 0)
-            return -1;
-        if (r > 0) {
-            data += r;
-            ret += r;
-        }
+            return ret > 0 ? ret : -1;
+        ret += r;
+        if (r < runLength)
+            break;
     }
     return ret;
 }
@@ -1272,6 +2461,11 @@ qint32 QSerialPortPrivate::settingFromBaudRate(qint32 baudRate)
     return standardBaudRateMap().value(baudRate);
 }
 
+qint32 QSerialPortPrivate::baudRateFromSetting(qint32 setting)
+{
+    return standardBaudRateMap().key(setting);
+}
+
 QList<qint32> QSerialPortPrivate::standardBaudRates()
 {
     return standardBaudRateMap().keys();
@@ -49,6 +49,8 @@
 #include <QtCore/qtimer.h>
 #include <algorithm>
 
+#include <qtserialport_tracepoints_p.h>
+
 QT_BEGIN_NAMESPACE
 
 static inline void qt_set_common_props(DCB *dcb)
@@ -281,6 +283,9 @@ void QSerialPortPrivate::close()
     delete startAsyncWriteTimer;
     startAsyncWriteTimer = nullptr;
 
+    stopFrameIdleTimer();
+    frameBuffer.clear();
+
     if (communicationStarted) {
         communicationCompletionOverlapped->dptr = nullptr;
         ::CancelIoEx(handle, communicationCompletionOverlapped);
@@ -564,6 +569,58 @@ bool QSerialPortPrivate::setFlowControl(QSerialPort::FlowControl flowControl)
     return setDcb(&dcb);
 }
 
+bool QSerialPortPrivate::applyConfiguration(const QSerialPort::Configuration &configuration)
+{
+    if (configuration.inputBaudRate != configuration.outputBaudRate) {
+        setError(QSerialPortErrorInfo(QSerialPort::UnsupportedOperationError, QSerialPort::tr("Custom baud rate direction is unsupported")));
+        return false;
+    }
+
+    DCB dcb;
+    if (!getDcb(&dcb))
+        return false;
+
+    qt_set_baudrate(&dcb, configuration.outputBaudRate);
+    qt_set_databits(&dcb, configuration.dataBits);
+    qt_set_parity(&dcb, configuration.parity);
+    qt_set_stopbits(&dcb, configuration.stopBits);
+    qt_set_flowcontrol(&dcb, configuration.flowControl);
+
+    return setDcb(&dcb);
+}
+
+bool QSerialPortPrivate::applyLowLatencyMode()
+{
+    // The latency of the Windows drivers is configured in the device manager.
+    return false;
+}
+
+void QSerialPortPrivate::restoreLowLatencyMode()
+{
+    lowLatencyFeatures = QSerialPort::NoLowLatencyFeature;
+}
+
+void QSerialPortPrivate::startFrameIdleTimer()
+{
+    Q_Q(QSerialPort);
+
+    if (!frameIdleTimer) {
+        frameIdleTimer = new QTimer(q);
+        frameIdleTimer->setTimerType(Qt::PreciseTimer);
+        frameIdleTimer->setSingleShot(true);
+        QObjectPrivate::connect(frameIdleTimer, &QTimer::timeout, this, &QSerialPortPrivate::frameIdleNotification);
+    }
+
+    const qint64 remaining = frameDeadline - QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+    frameIdleTimer->start(int((qMax(remaining, qint64(0)) + 999999) / 1000000));
+}
+
+void QSerialPortPrivate::stopFrameIdleTimer()
+{
+    delete frameIdleTimer;
+    frameIdleTimer = nullptr;
+}
+
 bool QSerialPortPrivate::completeAsyncCommunication(qint64 bytesTransferred)
 {
     communicationStarted = false;
@@ -584,21 +641,31 @@ bool QSerialPortPrivate::completeAsyncRead(qint64 bytesTransferred)
         readStarted = false;
         return false;
     }
-    if (bytesTransferred > 0)
+    statistics.recordRead(bytesTransferred);
+    if (bytesTransferred > 0) {
         buffer.append(readChunkBuffer.constData(), bytesTransferred);
+        recordReceivedData(bytesTransferred);
+    }
 
     readStarted = false;
 
+    if (bytesTransferred > 0 && readChunkPolicy == QSerialPort::AdaptiveReadChunk)
+        updateAdaptiveReadChunkSize(readBytesRequested, bytesTransferred);
+
     bool result = true;
-    if (bytesTransferred == QSERIALPORT_BUFFERSIZE
+    if (bytesTransferred == readBytesRequested
             || queuedBytesCount(QSerialPort::Input) > 0) {
         result = startAsyncRead();
     } else {
         result = startAsyncCommunication();
     }
 
-    if (bytesTransferred > 0)
-        emitReadyRead();
+    if (bytesTransferred > 0) {
+        if (frameIdleGap > 0)
+            takeFrameData();
+        else
+            emitReadyRead();
+    }
 
     return result;
 }
@@ -618,7 +685,11 @@ bool QSerialPortPrivate::completeAsyncWrite(qint64 bytesTransferred)
             return false;
         }
         Q_ASSERT(bytesTransferred == writeChunkBuffer.size());
+        Q_TRACE(QSerialPortPrivate_completeAsyncWrite, qint64(reinterpret_cast<qintptr>(handle)),
+                bytesTransferred, writeBuffer.size());
         writeChunkBuffer.clear();
+        statistics.recordWrite(bytesTransferred);
+        statistics.recordBytesWritten();
         emit q->bytesWritten(bytesTransferred);
         writeStarted = false;
     }
@@ -657,7 +728,7 @@ bool QSerialPortPrivate::startAsyncRead()
     if (readStarted)
         return true;
 
-    qint64 bytesToRead = QSERIALPORT_BUFFERSIZE;
+    qint64 bytesToRead = nextReadChunkSize();
 
     if (readBufferMaxSize && bytesToRead > (readBufferMaxSize - buffer.size())) {
         bytesToRead = readBufferMaxSize - buffer.size();
@@ -668,7 +739,9 @@ bool QSerialPortPrivate::startAsyncRead()
         }
     }
 
-    Q_ASSERT(int(bytesToRead) <= readChunkBuffer.size());
+    if (bytesToRead > readChunkBuffer.size())
+        readChunkBuffer.resize(bytesToRead);
+    readBytesRequested = bytesToRead;
 
     if (!readCompletionOverlapped)
         readCompletionOverlapped = new Overlapped(this);
@@ -700,6 +773,8 @@ bool QSerialPortPrivate::_q_startAsyncWrite()
         return true;
 
     writeChunkBuffer = writeBuffer.read();
+    Q_TRACE(QSerialPortPrivate_startAsyncWrite, qint64(reinterpret_cast<qintptr>(handle)),
+            writeBuffer.size() + writeChunkBuffer.size(), writeChunkBuffer.size());
 
     if (!writeCompletionOverlapped)
         writeCompletionOverlapped = new Overlapped(this);
@@ -751,6 +826,7 @@ void QSerialPortPrivate::emitReadyRead()
 {
     Q_Q(QSerialPort);
 
+    statistics.recordReadyRead();
     emit q->readyRead();
 }
 
@@ -761,13 +837,22 @@ qint64 QSerialPortPrivate::writeData(const char *data, qint64 maxSize)
     writeBuffer.append(data, maxSize);
 
     if (!writeBuffer.isEmpty() && !writeStarted) {
+        const bool coalesce = writePolicy == QSerialPort::CoalescedWrite
+                && writeBuffer.size() < writeCoalescingByteLimit;
+        if (writePolicy == QSerialPort::ImmediateWrite
+                || (writePolicy == QSerialPort::CoalescedWrite && !coalesce)) {
+            if (startAsyncWriteTimer)
+                startAsyncWriteTimer->stop();
+            _q_startAsyncWrite();
+            return maxSize;
+        }
         if (!startAsyncWriteTimer) {
             startAsyncWriteTimer = new QTimer(q);
             QObjectPrivate::connect(startAsyncWriteTimer, &QTimer::timeout, this, &QSerialPortPrivate::_q_startAsyncWrite);
             startAsyncWriteTimer->setSingleShot(true);
         }
         if (!startAsyncWriteTimer->isActive())
-            startAsyncWriteTimer->start();
+            startAsyncWriteTimer->start(coalesce ? writeCoalescingInterval() : 0);
     }
     return maxSize;
 }
@@ -0,0 +1,460 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtSerialPort module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qserialportframereader.h"
+#include "qserialportframereader_p.h"
+#include "qserialport.h"
+#include "qserialport_p.h"
+
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+QSerialPortFrameReaderPrivate::ScanResult
+QSerialPortFrameReaderPrivate::scan(const QSerialPortPrivate *port, qint64 *frameSize,
+                                    qint64 *skipSize)
+{
+    switch (framingMode) {
+    case QSerialPortFrameReader::DelimiterFraming:
+        return scanDelimited(port, frameSize, skipSize);
+    case QSerialPortFrameReader::FixedLengthFraming:
+        if (port->buffer.size() < fixedLength)
+            return FrameIncomplete;
+        *frameSize = fixedLength;
+        return FrameComplete;
+    case QSerialPortFrameReader::LengthPrefixFraming:
+        return scanLengthPrefixed(port, frameSize, skipSize);
+    case QSerialPortFrameReader::NoFraming:
+        break;
+    }
+    return FrameIncomplete;
+}
+
+QSerialPortFrameReaderPrivate::ScanResult
+QSerialPortFrameReaderPrivate::scanDelimited(const QSerialPortPrivate *port, qint64 *frameSize,
+                                             qint64 *skipSize)
+{
+    // Start behind what previous notifications have searched already.
+    const qint64 available = port->buffer.size();
+    const qint64 position = qt_serialport_find_delimiter(port->buffer, qMin(scannedBytes, available),
+                                                         delimiter, &scannedBytes);
+    if (position >= 0) {
+        *frameSize = position;
+        *skipSize = delimiter.size();
+        return FrameComplete;
+    }
+
+    if (maximumFrameSize > 0 && scannedBytes > maximumFrameSize) {
+        *skipSize = scannedBytes;
+        return FrameInvalid;
+    }
+    return FrameIncomplete;
+}
+
+QSerialPortFrameReaderPrivate::ScanResult
+QSerialPortFrameReaderPrivate::scanLengthPrefixed(const QSerialPortPrivate *port, qint64 *frameSize,
+                                                  qint64 *skipSize)
+{
+    const qint64 headerSize = lengthFieldOffset + lengthFieldSize;
+    if (port->buffer.size() < headerSize)
+        return FrameIncomplete;
+
+    uchar field[8] = {};
+    port->buffer.peek(reinterpret_cast<char *>(field), lengthFieldSize, lengthFieldOffset);
+
+    quint64 length = 0;
+    for (int i = 0; i < lengthFieldSize; ++i) {
+        const int shift = lengthFieldByteOrder == QSysInfo::BigEndian
+                ? 8 * (lengthFieldSize - 1 - i) : 8 * i;
+        length |= quint64(field[i]) << shift;
+    }
+
+    // A length which does not fit means the stream is out of step, skip a
+    // byte to look for the next header.
+    const qint64 total = length > quint64(std::numeric_limits<qint64>::max() / 2)
+            ? -1 : headerSize + qint64(length) + lengthAdjustment;
+    if (total < headerSize || (maximumFrameSize > 0 && total > maximumFrameSize)) {
+        *skipSize = 1;
+        return FrameInvalid;
+    }
+
+    if (port->buffer.size() < total)
+        return FrameIncomplete;
+    *frameSize = total;
+    return FrameComplete;
+}
+
+void QSerialPortFrameReaderPrivate::setFramingMode(QSerialPortFrameReader::FramingMode mode)
+{
+    framingMode = mode;
+    scannedBytes = 0;
+}
+
+void QSerialPortFrameReaderPrivate::processData()
+{
+    Q_Q(QSerialPortFrameReader);
+
+    // Look the port up again after each signal, since the slots may have
+    // closed it, deleted it or detached the reader.
+    for (;;) {
+        QSerialPort *serialPort = port.data();
+        if (!serialPort || !serialPort->isReadable())
+            return;
+
+        qint64 frameSize = 0;
+        qint64 skipSize = 0;
+        const ScanResult result = scan(QSerialPortPrivate::get(serialPort), &frameSize, &skipSize);
+        if (result == FrameIncomplete)
+            return;
+
+        scannedBytes = 0;
+
+        if (result == FrameInvalid) {
+            const qint64 discarded = serialPort->consume(skipSize);
+            emit q->dataDiscarded(discarded);
+            continue;
+        }
+
+        const QByteArray frame = serialPort->read(frameSize);
+        if (skipSize > 0)
+            serialPort->consume(skipSize);
+        emit q->frameReady(frame);
+    }
+}
+
+/*!
+    \class QSerialPortFrameReader
+
+    \brief Splits the data received by a serial port into frames.
+
+    \reentrant
+    \ingroup serialport-main
+    \inmodule QtSerialPort
+    \since 6.2
+
+    QSerialPortFrameReader watches the read buffer of a QSerialPort and
+    emits frameReady() for each complete frame in it. The frames are
+    delimited in one of the following ways:
+
+    \list
+    \li by a delimiter, set with setDelimiter();
+    \li by a fixed length, set with setFixedLength();
+    \li by a length field in a header, set with setLengthPrefix().
+    \endlist
+
+    The read buffer is searched in place, and each frame is copied once,
+    when it is taken out of the buffer. The search for delimiters resumes
+    where the previous one stopped, so data which arrives in many small
+    pieces is not searched again and again. On x86 and 64-bit ARM, the
+    search uses SSE2, AVX2 or NEON instructions, depending on the
+    processor.
+
+    \code
+    QSerialPortFrameReader reader(&serial);
+    reader.setDelimiter("\r\n");
+    connect(&reader, &QSerialPortFrameReader::frameReady,
+            this, &NmeaParser::parseSentence);
+    \endcode
+
+    The reader takes its data out of the read buffer of the port. It should
+    be the only consumer of the port's data, so nothing else should read
+    from the port while a framing mode is set.
+
+    \sa QSerialPort::readableSpans()
+*/
+
+/*!
+    \enum QSerialPortFrameReader::FramingMode
+
+    This enum describes how the received data is split into frames.
+
+    \value NoFraming        No frames are detected; this is the default.
+    \value DelimiterFraming Frames end with a delimiter, which is not part
+                            of the frame.
+    \value FixedLengthFraming All frames have the same length.
+    \value LengthPrefixFraming Frames begin with a header holding the length
+                            of the frame.
+*/
+
+/*!
+    \fn void QSerialPortFrameReader::frameReady(const QByteArray &frame)
+
+    This signal is emitted for each complete \a frame taken out of the read
+    buffer of the port.
+*/
+
+/*!
+    \fn void QSerialPortFrameReader::dataDiscarded(qint64 size)
+
+    This signal is emitted when \a size bytes are dropped from the read
+    buffer because they cannot be part of a valid frame. This happens when
+    no delimiter is found within maximumFrameSize() bytes, or when a length
+    field holds an impossible length.
+*/
+
+/*!
+    Constructs a frame reader with the given \a parent, without a port.
+
+    \sa setPort()
+*/
+QSerialPortFrameReader::QSerialPortFrameReader(QObject *parent)
+    : QObject(*new QSerialPortFrameReaderPrivate, parent)
+{
+}
+
+/*!
+    Constructs a frame reader for the serial \a port with the given
+    \a parent.
+*/
+QSerialPortFrameReader::QSerialPortFrameReader(QSerialPort *port, QObject *parent)
+    : QSerialPortFrameReader(parent)
+{
+    setPort(port);
+}
+
+/*!
+    Destroys the frame reader.
+*/
+QSerialPortFrameReader::~QSerialPortFrameReader()
+{
+}
+
+/*!
+    Returns the serial port of the reader, or \c nullptr if there is none.
+
+    \sa setPort()
+*/
+QSerialPort *QSerialPortFrameReader::port() const
+{
+    Q_D(const QSerialPortFrameReader);
+    return d->port.data();
+}
+
+/*!
+    Sets the serial \a port to read frames from. Frames already complete in
+    its read buffer are delivered once control returns to the event loop.
+
+    \sa port()
+*/
+void QSerialPortFrameReader::setPort(QSerialPort *port)
+{
+    Q_D(QSerialPortFrameReader);
+
+    if (d->port == port)
+        return;
+
+    QObject::disconnect(d->readyReadConnection);
+    d->port = port;
+    d->scannedBytes = 0;
+
+    if (!port)
+        return;
+
+    d->readyReadConnection = QObjectPrivate::connect(port, &QIODevice::readyRead,
+                                                     d, &QSerialPortFrameReaderPrivate::processData);
+    if (port->bytesAvailable() > 0) {
+        QMetaObject::invokeMethod(this, [d]() { d->processData(); }, Qt::QueuedConnection);
+    }
+}
+
+/*!
+    Returns the framing mode, which is set by setDelimiter(),
+    setFixedLength() or setLengthPrefix().
+*/
+QSerialPortFrameReader::FramingMode QSerialPortFrameReader::framingMode() const
+{
+    Q_D(const QSerialPortFrameReader);
+    return d->framingMode;
+}
+
+/*!
+    Returns the delimiter which ends the frames.
+
+    \sa setDelimiter()
+*/
+QByteArray QSerialPortFrameReader::delimiter() const
+{
+    Q_D(const QSerialPortFrameReader);
+    return d->delimiter;
+}
+
+/*!
+    Sets the framing mode to DelimiterFraming, with frames ending at the
+    given \a delimiter. The delimiter is removed from the read buffer but
+    is not part of the emitted frames. An empty \a delimiter sets the mode
+    to NoFraming.
+
+    \sa delimiter(), framingMode()
+*/
+void QSerialPortFrameReader::setDelimiter(const QByteArray &delimiter)
+{
+    Q_D(QSerialPortFrameReader);
+    d->delimiter = delimiter;
+    d->setFramingMode(delimiter.isEmpty() ? NoFraming : DelimiterFraming);
+}
+
+/*!
+    Returns the length of the frames in FixedLengthFraming mode.
+
+    \sa setFixedLength()
+*/
+qint64 QSerialPortFrameReader::fixedLength() const
+{
+    Q_D(const QSerialPortFrameReader);
+    return d->fixedLength;
+}
+
+/*!
+    Sets the framing mode to FixedLengthFraming, with frames of \a length
+    bytes each. A \a length of \c 0 or less sets the mode to NoFraming.
+
+    \sa fixedLength(), framingMode()
+*/
+void QSerialPortFrameReader::setFixedLength(qint64 length)
+{
+    Q_D(QSerialPortFrameReader);
+    d->fixedLength = qMax(length, qint64(0));
+    d->setFramingMode(d->fixedLength > 0 ? FixedLengthFraming : NoFraming);
+}
+
+/*!
+    Returns the offset of the length field from the beginning of the frame.
+
+    \sa setLengthPrefix()
+*/
+int QSerialPortFrameReader::lengthFieldOffset() const
+{
+    Q_D(const QSerialPortFrameReader);
+    return d->lengthFieldOffset;
+}
+
+/*!
+    Returns the size of the length field, in bytes.
+
+    \sa setLengthPrefix()
+*/
+int QSerialPortFrameReader::lengthFieldSize() const
+{
+    Q_D(const QSerialPortFrameReader);
+    return d->lengthFieldSize;
+}
+
+/*!
+    Returns the byte order of the length field.
+
+    \sa setLengthPrefix()
+*/
+QSysInfo::Endian QSerialPortFrameReader::lengthFieldByteOrder() const
+{
+    Q_D(const QSerialPortFrameReader);
+    return d->lengthFieldByteOrder;
+}
+
+/*!
+    Returns the number of bytes added to the value of the length field.
+
+    \sa setLengthPrefix()
+*/
+qint64 QSerialPortFrameReader::lengthAdjustment() const
+{
+    Q_D(const QSerialPortFrameReader);
+    return d->lengthAdjustment;
+}
+
+/*!
+    Sets the framing mode to LengthPrefixFraming. The frames begin with a
+    header with an unsigned length field of \a fieldSize bytes, between
+    \c 1 and \c 8, at \a fieldOffset bytes from the beginning of the frame.
+    The field is stored in the \a byteOrder.
+
+    The field holds the number of bytes following it, plus
+    \a lengthAdjustment. For example, a field which counts a two byte
+    checksum at the end of the frame as well needs an adjustment of \c 0,
+    and one which only counts the payload before that checksum needs
+    \c 2. The emitted frames include the header.
+
+    An invalid \a fieldOffset or \a fieldSize sets the mode to NoFraming.
+
+    \sa framingMode(), maximumFrameSize()
+*/
+void QSerialPortFrameReader::setLengthPrefix(int fieldOffset, int fieldSize,
+                                             QSysInfo::Endian byteOrder,
+                                             qint64 lengthAdjustment)
+{
+    Q_D(QSerialPortFrameReader);
+
+    const bool valid = fieldOffset >= 0 && fieldSize >= 1 && fieldSize <= 8;
+    d->lengthFieldOffset = valid ? fieldOffset : 0;
+    d->lengthFieldSize = valid ? fieldSize : 2;
+    d->lengthFieldByteOrder = byteOrder;
+    d->lengthAdjustment = lengthAdjustment;
+    d->setFramingMode(valid ? LengthPrefixFraming : NoFraming);
+}
+
+/*!
+    Returns the size of the largest accepted frame, in bytes.
+
+    \sa setMaximumFrameSize()
+*/
+qint64 QSerialPortFrameReader::maximumFrameSize() const
+{
+    Q_D(const QSerialPortFrameReader);
+    return d->maximumFrameSize;
+}
+
+/*!
+    Sets the size of the largest accepted frame to \a size bytes. A
+    \a size of \c 0 removes the limit. The default is 64 KiB.
+
+    In DelimiterFraming mode, data which holds no delimiter within \a size
+    bytes is dropped. In LengthPrefixFraming mode, a header announcing a
+    larger frame is taken as noise, and the data is searched for the next
+    header byte by byte. The dropped data is reported by dataDiscarded().
+
+    \sa maximumFrameSize()
+*/
+void QSerialPortFrameReader::setMaximumFrameSize(qint64 size)
+{
+    Q_D(QSerialPortFrameReader);
+    d->maximumFrameSize = qMax(size, qint64(0));
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qserialportframereader.cpp"
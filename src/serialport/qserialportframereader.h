@@ -0,0 +1,104 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtSerialPort module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QSERIALPORTFRAMEREADER_H
+#define QSERIALPORTFRAMEREADER_H
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qsysinfo.h>
+
+#include <QtSerialPort/qserialportglobal.h>
+
+QT_BEGIN_NAMESPACE
+
+class QSerialPort;
+class QSerialPortFrameReaderPrivate;
+
+class Q_SERIALPORT_EXPORT QSerialPortFrameReader : public QObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(QSerialPortFrameReader)
+
+public:
+    enum FramingMode {
+        NoFraming,
+        DelimiterFraming,
+        FixedLengthFraming,
+        LengthPrefixFraming
+    };
+    Q_ENUM(FramingMode)
+
+    explicit QSerialPortFrameReader(QObject *parent = nullptr);
+    explicit QSerialPortFrameReader(QSerialPort *port, QObject *parent = nullptr);
+    ~QSerialPortFrameReader();
+
+    QSerialPort *port() const;
+    void setPort(QSerialPort *port);
+
+    FramingMode framingMode() const;
+
+    QByteArray delimiter() const;
+    void setDelimiter(const QByteArray &delimiter);
+
+    qint64 fixedLength() const;
+    void setFixedLength(qint64 length);
+
+    int lengthFieldOffset() const;
+    int lengthFieldSize() const;
+    QSysInfo::Endian lengthFieldByteOrder() const;
+    qint64 lengthAdjustment() const;
+    void setLengthPrefix(int fieldOffset, int fieldSize,
+                         QSysInfo::Endian byteOrder = QSysInfo::BigEndian,
+                         qint64 lengthAdjustment = 0);
+
+    qint64 maximumFrameSize() const;
+    void setMaximumFrameSize(qint64 size);
+
+Q_SIGNALS:
+    void frameReady(const QByteArray &frame);
+    void dataDiscarded(qint64 size);
+
+private:
+    Q_DISABLE_COPY(QSerialPortFrameReader)
+};
+
+QT_END_NAMESPACE
+
+#endif // QSERIALPORTFRAMEREADER_H
@@ -0,0 +1,100 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtSerialPort module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QSERIALPORTFRAMEREADER_P_H
+#define QSERIALPORTFRAMEREADER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qserialportframereader.h"
+
+#include <QtCore/qpointer.h>
+
+#include <private/qobject_p.h>
+
+QT_BEGIN_NAMESPACE
+
+class QSerialPortPrivate;
+
+class QSerialPortFrameReaderPrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(QSerialPortFrameReader)
+public:
+    enum ScanResult {
+        FrameIncomplete,
+        FrameComplete,
+        FrameInvalid
+    };
+
+    ScanResult scan(const QSerialPortPrivate *port, qint64 *frameSize, qint64 *skipSize);
+    ScanResult scanDelimited(const QSerialPortPrivate *port, qint64 *frameSize, qint64 *skipSize);
+    ScanResult scanLengthPrefixed(const QSerialPortPrivate *port, qint64 *frameSize, qint64 *skipSize);
+
+    void setFramingMode(QSerialPortFrameReader::FramingMode mode);
+    void processData();
+
+    QPointer<QSerialPort> port;
+    QMetaObject::Connection readyReadConnection;
+
+    QSerialPortFrameReader::FramingMode framingMode = QSerialPortFrameReader::NoFraming;
+    QByteArray delimiter;
+    qint64 fixedLength = 0;
+    int lengthFieldOffset = 0;
+    int lengthFieldSize = 2;
+    QSysInfo::Endian lengthFieldByteOrder = QSysInfo::BigEndian;
+    qint64 lengthAdjustment = 0;
+    qint64 maximumFrameSize = 64 * 1024;
+
+    // The bytes at the start of the read buffer known not to begin a
+    // delimiter, so that each byte is searched only once.
+    qint64 scannedBytes = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSERIALPORTFRAMEREADER_P_H
@@ -0,0 +1,373 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtSerialPort module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qserialportgroup.h"
+#include "qserialportgroup_p.h"
+#include "qserialport.h"
+#include "qserialport_p.h"
+
+#include <QtCore/qsocketnotifier.h>
+
+#ifdef Q_OS_LINUX
+#include <private/qcore_unix_p.h>
+
+#include <errno.h>
+#include <sys/epoll.h>
+#endif
+
+QT_BEGIN_NAMESPACE
+
+#ifdef Q_OS_LINUX
+// The number of events collected by one epoll_wait() call.
+static const int maximumEventCount = 128;
+#endif
+
+QSerialPortGroupPrivate::QSerialPortGroupPrivate()
+{
+#ifdef Q_OS_LINUX
+    epollDescriptor = ::epoll_create1(EPOLL_CLOEXEC);
+#endif
+}
+
+QSerialPortGroupPrivate::~QSerialPortGroupPrivate()
+{
+#ifdef Q_OS_LINUX
+    if (epollDescriptor != -1)
+        qt_safe_close(epollDescriptor);
+#endif
+}
+
+bool QSerialPortGroupPrivate::attachPort(QSerialPortPrivate *port)
+{
+#ifdef Q_OS_LINUX
+    Q_Q(QSerialPortGroup);
+
+    if (epollDescriptor == -1 || port->readThread || port->ioUring)
+        return false;
+
+    if (!notifier) {
+        notifier = new QSocketNotifier(epollDescriptor, QSocketNotifier::Read, q);
+        QObjectPrivate::connect(notifier, &QSocketNotifier::activated,
+                                this, &QSerialPortGroupPrivate::dispatch);
+    }
+
+    // Take over the notifications of an open port in their current state.
+    const bool readEnabled = port->isReadNotificationEnabled();
+    const bool writeEnabled = port->isWriteNotificationEnabled();
+
+    delete port->readNotifier;
+    port->readNotifier = nullptr;
+
+    delete port->writeNotifier;
+    port->writeNotifier = nullptr;
+
+    port->group = this;
+    port->groupKey = nextPortKey++;
+    port->groupReadNotificationEnabled = readEnabled;
+    port->groupWriteNotificationEnabled = writeEnabled;
+    ports.insert(port->groupKey, port->q_func());
+
+    if (port->descriptor != -1 && !updatePort(port)) {
+        detachPort(port);
+        return false;
+    }
+    return true;
+#else
+    Q_UNUSED(port);
+    return false;
+#endif
+}
+
+void QSerialPortGroupPrivate::detachPort(QSerialPortPrivate *port)
+{
+#ifdef Q_OS_LINUX
+    unregisterPort(port);
+    ports.remove(port->groupKey);
+
+    const bool readEnabled = port->groupReadNotificationEnabled;
+    const bool writeEnabled = port->groupWriteNotificationEnabled;
+
+    port->group = nullptr;
+    port->groupKey = 0;
+    port->groupReadNotificationEnabled = false;
+    port->groupWriteNotificationEnabled = false;
+
+    // Hand the notifications back to the port.
+    if (port->descriptor != -1) {
+        if (readEnabled)
+            port->setReadNotificationEnabled(true);
+        if (writeEnabled)
+            port->setWriteNotificationEnabled(true);
+    }
+#else
+    Q_UNUSED(port);
+#endif
+}
+
+bool QSerialPortGroupPrivate::updatePort(QSerialPortPrivate *port)
+{
+#ifdef Q_OS_LINUX
+    if (port->descriptor == -1)
+        return false;
+
+    // Modifying the registration also checks the descriptor again, so
+    // that enabling a notification reports data which arrived while it
+    // was disabled, although no new edge occurs.
+    epoll_event event = {};
+    event.events = EPOLLET;
+    if (port->groupReadNotificationEnabled)
+        event.events |= EPOLLIN;
+    if (port->groupWriteNotificationEnabled)
+        event.events |= EPOLLOUT;
+    event.data.u64 = port->groupKey;
+
+    const int operation = port->groupRegistered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    if (::epoll_ctl(epollDescriptor, operation, port->descriptor, &event) == -1)
+        return false;
+
+    port->groupRegistered = true;
+    return true;
+#else
+    Q_UNUSED(port);
+    return false;
+#endif
+}
+
+void QSerialPortGroupPrivate::unregisterPort(QSerialPortPrivate *port)
+{
+#ifdef Q_OS_LINUX
+    if (!port->groupRegistered)
+        return;
+
+    epoll_event event = {};
+    ::epoll_ctl(epollDescriptor, EPOLL_CTL_DEL, port->descriptor, &event);
+    port->groupRegistered = false;
+#else
+    Q_UNUSED(port);
+#endif
+}
+
+QSerialPortPrivate *QSerialPortGroupPrivate::portForKey(quint64 key) const
+{
+    QSerialPort *port = ports.value(key);
+    return port ? QSerialPortPrivate::get(port) : nullptr;
+}
+
+void QSerialPortGroupPrivate::dispatch()
+{
+#ifdef Q_OS_LINUX
+    epoll_event events[maximumEventCount];
+    int eventCount = 0;
+    EINTR_LOOP(eventCount, ::epoll_wait(epollDescriptor, events, maximumEventCount, 0));
+
+    for (int i = 0; i < eventCount; ++i) {
+        const quint64 key = events[i].data.u64;
+        const quint32 flags = events[i].events;
+
+        // Look the port up before each step, since the slots invoked by
+        // the previous one may have closed, removed or deleted it.
+        if (flags & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+            QSerialPortPrivate *port = portForKey(key);
+            if (port && port->groupReadNotificationEnabled)
+                port->readNotification();
+        }
+
+        if (flags & (EPOLLOUT | EPOLLHUP | EPOLLERR)) {
+            QSerialPortPrivate *port = portForKey(key);
+            if (port && port->groupWriteNotificationEnabled) {
+                port->completeAsyncWrite();
+                // A write which did not fill the driver buffer leaves the
+                // descriptor writable, so no new edge follows it.
+                port = portForKey(key);
+                if (port && port->groupWriteNotificationEnabled)
+                    updatePort(port);
+            }
+        }
+    }
+#endif
+}
+
+/*!
+    \class QSerialPortGroup
+
+    \brief Serves the notifications of many serial ports at once.
+
+    \reentrant
+    \ingroup serialport-main
+    \inmodule QtSerialPort
+    \since 6.2
+
+    Each open QSerialPort watches its device with notifiers of its own,
+    which are enabled and disabled as data is read and written. With
+    hundreds of ports, this becomes a significant share of the work of the
+    event loop.
+
+    QSerialPortGroup replaces the notifiers of the ports added to it with
+    a single epoll instance. The event loop only watches the group, which
+    then handles the events of all ready ports in batches. The port
+    descriptors are registered edge-triggered, so each port is drained
+    completely whenever it reports new data, as if batched reading was
+    enabled without limits.
+
+    \code
+    QSerialPortGroup group;
+    for (const QSerialPortInfo &info : QSerialPortInfo::availablePorts()) {
+        auto port = new QSerialPort(info, &group);
+        group.addPort(port);
+        port->open(QIODevice::ReadWrite);
+    }
+    \endcode
+
+    Ports can be added before or after they have been opened, and keep
+    working as usual when removed from the group. The signals of the ports
+    are emitted from the thread the group lives in, which must be the thread
+    of the ports. To spread many ports over several threads, create one
+    group per thread.
+
+    \note QSerialPortGroup is only supported on Linux.
+
+    \sa QSerialPort::setReadBatchingEnabled()
+*/
+
+/*!
+    Constructs a new, empty serial port group with the given \a parent.
+*/
+QSerialPortGroup::QSerialPortGroup(QObject *parent)
+    : QObject(*new QSerialPortGroupPrivate, parent)
+{
+}
+
+/*!
+    Removes all ports from the group and destroys it.
+*/
+QSerialPortGroup::~QSerialPortGroup()
+{
+    Q_D(QSerialPortGroup);
+    const QList<QSerialPort *> ports = d->ports.values();
+    for (QSerialPort *port : ports)
+        d->detachPort(QSerialPortPrivate::get(port));
+}
+
+/*!
+    Returns \c true if serial port groups are supported on this platform;
+    otherwise returns \c false.
+*/
+bool QSerialPortGroup::isSupported()
+{
+#ifdef Q_OS_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*!
+    Adds \a port to the group, and returns \c true on success; otherwise
+    returns \c false.
+
+    The port must live in the same thread as the group. A port which is
+    open and reads in a dedicated thread cannot be added; ports in a group
+    ignore QSerialPort::setReadThreadEnabled() when opened.
+
+    \sa removePort(), ports()
+*/
+bool QSerialPortGroup::addPort(QSerialPort *port)
+{
+    Q_D(QSerialPortGroup);
+
+    if (!port || port->thread() != thread())
+        return false;
+
+#ifdef Q_OS_LINUX
+    QSerialPortPrivate *portPrivate = QSerialPortPrivate::get(port);
+    if (portPrivate->group == d)
+        return true;
+    if (portPrivate->group)
+        return false;
+    return d->attachPort(portPrivate);
+#else
+    Q_UNUSED(d);
+    return false;
+#endif
+}
+
+/*!
+    Removes \a port from the group, and returns \c true if it was part of
+    the group; otherwise returns \c false. An open port continues to work
+    with notifiers of its own.
+
+    Destroyed ports are removed from the group automatically.
+
+    \sa addPort()
+*/
+bool QSerialPortGroup::removePort(QSerialPort *port)
+{
+    Q_D(QSerialPortGroup);
+
+#ifdef Q_OS_LINUX
+    if (!port)
+        return false;
+
+    QSerialPortPrivate *portPrivate = QSerialPortPrivate::get(port);
+    if (portPrivate->group != d)
+        return false;
+
+    d->detachPort(portPrivate);
+    return true;
+#else
+    Q_UNUSED(d);
+    Q_UNUSED(port);
+    return false;
+#endif
+}
+
+/*!
+    Returns the ports in the group, in the order in which they were added.
+
+    \sa addPort()
+*/
+QList<QSerialPort *> QSerialPortGroup::ports() const
+{
+    Q_D(const QSerialPortGroup);
+    return d->ports.values();
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qserialportgroup.cpp"
@@ -0,0 +1,318 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtSerialPort module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qserialportiouring_p.h"
+#include "qserialport_p.h"
+
+#include <QtCore/qsocketnotifier.h>
+
+#include <private/qcore_unix_p.h>
+
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+
+QT_BEGIN_NAMESPACE
+
+// Enough entries for a read and a write of a few dozen ports per pass.
+static const unsigned ringEntryCount = 256;
+
+static thread_local QSerialPortIoUring *threadIoUring = nullptr;
+
+// The operation type is kept in the low bits of the port pointer.
+static void *operationTag(QSerialPortPrivate *port, QSerialPortIoUring::OperationType type)
+{
+    return reinterpret_cast<void *>(reinterpret_cast<quintptr>(port) | quintptr(type));
+}
+
+QSerialPortIoUring::QSerialPortIoUring()
+{
+}
+
+QSerialPortIoUring::~QSerialPortIoUring()
+{
+    delete notifier;
+    if (ringInitialized)
+        ::io_uring_queue_exit(&ring);
+    if (eventDescriptor != -1)
+        qt_safe_close(eventDescriptor);
+}
+
+QSerialPortIoUring *QSerialPortIoUring::acquire()
+{
+    if (!threadIoUring) {
+        QSerialPortIoUring *newIoUring = new QSerialPortIoUring;
+        if (!newIoUring->initialize()) {
+            // Kernels without io_uring, or with it disabled, fall back to
+            // the readiness based notifications.
+            delete newIoUring;
+            return nullptr;
+        }
+        threadIoUring = newIoUring;
+    }
+
+    ++threadIoUring->referenceCount;
+    return threadIoUring;
+}
+
+void QSerialPortIoUring::release()
+{
+    if (--referenceCount > 0)
+        return;
+
+    if (threadIoUring == this)
+        threadIoUring = nullptr;
+
+    if (notificationActive) {
+        // The notifier is in the middle of delivering its event, and the
+        // event loop that runs it will also run the deferred deletion.
+        deleteLater();
+    } else if (deliveryDepth > 0) {
+        deletePending = true;
+    } else {
+        // Without an event loop, deleteLater() would never run.
+        delete this;
+    }
+}
+
+bool QSerialPortIoUring::initialize()
+{
+    if (::io_uring_queue_init(ringEntryCount, &ring, 0) < 0)
+        return false;
+    ringInitialized = true;
+
+    eventDescriptor = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (eventDescriptor == -1 || ::io_uring_register_eventfd(&ring, eventDescriptor) < 0)
+        return false;
+
+    notifier = new QSocketNotifier(eventDescriptor, QSocketNotifier::Read);
+    QObject::connect(notifier, &QSocketNotifier::activated, this, [this]() { notification(); });
+    return true;
+}
+
+io_uring_sqe *QSerialPortIoUring::nextSubmissionEntry()
+{
+    io_uring_sqe *entry = ::io_uring_get_sqe(&ring);
+    if (!entry) {
+        // The submission queue is full, hand it over to the kernel.
+        ::io_uring_submit(&ring);
+        entry = ::io_uring_get_sqe(&ring);
+    }
+    return entry;
+}
+
+bool QSerialPortIoUring::submitRead(QSerialPortPrivate *port, char *data, qint64 size)
+{
+    // Both entries have to fit, a link must not be split across submissions.
+    if (::io_uring_sq_space_left(&ring) < 2)
+        ::io_uring_submit(&ring);
+
+    io_uring_sqe *pollEntry = nextSubmissionEntry();
+    io_uring_sqe *readEntry = pollEntry ? nextSubmissionEntry() : nullptr;
+    if (!readEntry) {
+        errno = EBUSY;
+        return false;
+    }
+
+    // The port is non-blocking, so the read is linked to a poll for input
+    // and runs in the kernel as soon as data arrives.
+    ::io_uring_prep_poll_add(pollEntry, port->descriptor, POLLIN);
+    pollEntry->flags |= IOSQE_IO_LINK;
+    ::io_uring_sqe_set_data(pollEntry, operationTag(port, ReadPollOperation));
+
+    ::io_uring_prep_read(readEntry, port->descriptor, data, unsigned(size), 0);
+    ::io_uring_sqe_set_data(readEntry, operationTag(port, ReadOperation));
+
+    port->ioUringPendingOperations += 2;
+    scheduleSubmit();
+    return true;
+}
+
+bool QSerialPortIoUring::submitWrite(QSerialPortPrivate *port, const iovec *vectors, int vectorCount)
+{
+    if (::io_uring_sq_space_left(&ring) < 2)
+        ::io_uring_submit(&ring);
+
+    io_uring_sqe *pollEntry = nextSubmissionEntry();
+    io_uring_sqe *writeEntry = pollEntry ? nextSubmissionEntry() : nullptr;
+    if (!writeEntry) {
+        errno = EBUSY;
+        return false;
+    }
+
+    ::io_uring_prep_poll_add(pollEntry, port->descriptor, POLLOUT);
+    pollEntry->flags |= IOSQE_IO_LINK;
+    ::io_uring_sqe_set_data(pollEntry, operationTag(port, WritePollOperation));
+
+    ::io_uring_prep_writev(writeEntry, port->descriptor, vectors, unsigned(vectorCount), 0);
+    ::io_uring_sqe_set_data(writeEntry, operationTag(port, WriteOperation));
+
+    port->ioUringPendingOperations += 2;
+    scheduleSubmit();
+    return true;
+}
+
+void QSerialPortIoUring::scheduleSubmit()
+{
+    // Collect the operations queued by all ports during this pass of the
+    // event loop into a single io_uring_enter() call.
+    if (submitScheduled)
+        return;
+    submitScheduled = true;
+    QMetaObject::invokeMethod(this, [this]() {
+        if (submitScheduled)
+            submit();
+    }, Qt::QueuedConnection);
+}
+
+void QSerialPortIoUring::submit()
+{
+    submitScheduled = false;
+    ::io_uring_submit(&ring);
+}
+
+void QSerialPortIoUring::cancel(QSerialPortPrivate *port)
+{
+    if (port->ioUringPendingOperations > 0) {
+        // Canceling the polls also cancels the operations linked to them.
+        for (OperationType type : { ReadPollOperation, WritePollOperation }) {
+            io_uring_sqe *entry = nextSubmissionEntry();
+            if (!entry)
+                break;
+            ::io_uring_prep_cancel(entry, operationTag(port, type), 0);
+            ::io_uring_sqe_set_data(entry, nullptr);
+        }
+        submit();
+
+        // The buffers of the port must stay valid until the kernel is done
+        // with them. Completions of other ports are kept for later.
+        while (port->ioUringPendingOperations > 0) {
+            io_uring_cqe *entry = nullptr;
+            if (::io_uring_wait_cqe(&ring, &entry) < 0)
+                break;
+            collectCompletions();
+        }
+    }
+
+    completions.removeIf([port](const Completion &completion) {
+        return completion.port == port;
+    });
+}
+
+bool QSerialPortIoUring::waitForCompletions(QDeadlineTimer deadline)
+{
+    if (completions.isEmpty()) {
+        if (submitScheduled)
+            submit();
+
+        io_uring_cqe *entry = nullptr;
+        int result;
+        if (deadline.isForever()) {
+            result = ::io_uring_wait_cqe(&ring, &entry);
+        } else {
+            const qint64 remaining = deadline.remainingTimeNSecs();
+            __kernel_timespec timeout;
+            timeout.tv_sec = remaining / 1000000000;
+            timeout.tv_nsec = remaining % 1000000000;
+            result = ::io_uring_wait_cqe_timeout(&ring, &entry, &timeout);
+        }
+        if (result < 0)
+            return false;
+        collectCompletions();
+    }
+
+    // The ring may be gone afterwards, but the ports know that already.
+    deliverCompletions();
+    return true;
+}
+
+void QSerialPortIoUring::notification()
+{
+    quint64 value = 0;
+    qt_safe_read(eventDescriptor, &value, sizeof(value));
+
+    collectCompletions();
+
+    notificationActive = true;
+    const bool alive = deliverCompletions();
+    if (!alive)
+        return;
+    notificationActive = false;
+
+    // Submit the operations restarted by the ports in one go.
+    if (submitScheduled)
+        submit();
+}
+
+void QSerialPortIoUring::collectCompletions()
+{
+    // Take the entries out of the completion queue before delivering them,
+    // the ports may wait on the ring again from their signal handlers.
+    io_uring_cqe *entry = nullptr;
+    while (::io_uring_peek_cqe(&ring, &entry) == 0 && entry) {
+        const quintptr tag = reinterpret_cast<quintptr>(::io_uring_cqe_get_data(entry));
+        const int result = entry->res;
+        ::io_uring_cqe_seen(&ring, entry);
+
+        if (!tag)
+            continue; // A cancellation request.
+
+        QSerialPortPrivate *port = reinterpret_cast<QSerialPortPrivate *>(tag & ~quintptr(3));
+        --port->ioUringPendingOperations;
+        completions.append({ port, OperationType(tag & 3), result });
+    }
+}
+
+// Returns false if the ring has been deleted meanwhile.
+bool QSerialPortIoUring::deliverCompletions()
+{
+    ++deliveryDepth;
+    while (!completions.isEmpty()) {
+        const Completion completion = completions.takeFirst();
+        completion.port->completeIoUringOperation(completion.type, completion.result);
+    }
+
+    if (--deliveryDepth == 0 && deletePending) {
+        delete this;
+        return false;
+    }
+    return true;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,124 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtSerialPort module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QSERIALPORTIOURING_P_H
+#define QSERIALPORTIOURING_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qdeadlinetimer.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qobject.h>
+
+#include <liburing.h>
+
+QT_BEGIN_NAMESPACE
+
+class QSerialPortPrivate;
+class QSocketNotifier;
+
+// An io_uring instance shared by all ports of a thread. Operations are
+// queued by the ports and submitted together once per pass of the event
+// loop; completions are signaled by an eventfd.
+class QSerialPortIoUring : public QObject
+{
+public:
+    enum OperationType {
+        ReadPollOperation,
+        ReadOperation,
+        WritePollOperation,
+        WriteOperation
+    };
+
+    static QSerialPortIoUring *acquire();
+    void release();
+
+    bool submitRead(QSerialPortPrivate *port, char *data, qint64 size);
+    bool submitWrite(QSerialPortPrivate *port, const iovec *vectors, int vectorCount);
+    void submit();
+
+    void cancel(QSerialPortPrivate *port);
+    bool waitForCompletions(QDeadlineTimer deadline);
+
+private:
+    QSerialPortIoUring();
+    ~QSerialPortIoUring();
+
+    bool initialize();
+
+    io_uring_sqe *nextSubmissionEntry();
+    void scheduleSubmit();
+
+    void notification();
+    void collectCompletions();
+    bool deliverCompletions();
+
+    struct Completion
+    {
+        QSerialPortPrivate *port;
+        OperationType type;
+        int result;
+    };
+
+    io_uring ring;
+    bool ringInitialized = false;
+    int eventDescriptor = -1;
+    QSocketNotifier *notifier = nullptr;
+    int referenceCount = 0;
+    bool submitScheduled = false;
+    // The ports may release the ring while completions are delivered to
+    // them, it is deleted once the delivery is over.
+    int deliveryDepth = 0;
+    bool notificationActive = false;
+    bool deletePending = false;
+    QList<Completion> completions;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSERIALPORTIOURING_P_H
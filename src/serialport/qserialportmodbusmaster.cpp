@@ -0,0 +1,472 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtSerialPort module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qserialportmodbusmaster.h"
+#include "qserialportmodbusmaster_p.h"
+#include "qserialport.h"
+#include "qserialport_p.h"
+
+#include <QtCore/qtimer.h>
+
+QT_BEGIN_NAMESPACE
+
+// Broadcast requests go to all slaves, none of them replies.
+static const int broadcastAddress = 0;
+static const int maximumSlaveAddress = 247;
+// An RTU frame holds at most 256 bytes: address, PDU and CRC.
+static const qsizetype maximumPduSize = 253;
+
+struct ModbusCrcTable
+{
+    quint16 values[256];
+};
+
+// The CRC-16 of Modbus, with the reflected polynomial 0xA001, one table
+// lookup per byte.
+static constexpr ModbusCrcTable makeModbusCrcTable()
+{
+    ModbusCrcTable table = {};
+    for (int i = 0; i < 256; ++i) {
+        quint16 crc = quint16(i);
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc & 1) ? quint16((crc >> 1) ^ 0xA001) : quint16(crc >> 1);
+        table.values[i] = crc;
+    }
+    return table;
+}
+
+static constexpr ModbusCrcTable modbusCrcTable = makeModbusCrcTable();
+
+void QSerialPortModbusMasterPrivate::updateFrameGap()
+{
+    if (!port)
+        return;
+
+    // Frames end after a silence of 3.5 characters. Above 19200 bauds the
+    // specification fixes the silence at 1750 microseconds instead.
+    const qint64 characterTime = QSerialPortPrivate::get(port)->characterTimeNsecs();
+    const double gap = port->baudRate(QSerialPort::Input) > 19200 && characterTime > 0
+            ? 1750000.0 / characterTime : 3.5;
+    port->setFrameIdleGap(gap);
+}
+
+qint64 QSerialPortModbusMasterPrivate::transmissionTime(qint64 size) const
+{
+    // In milliseconds, rounded up.
+    const qint64 characterTime = QSerialPortPrivate::get(port)->characterTimeNsecs();
+    return (size * characterTime + 999999) / 1000000;
+}
+
+void QSerialPortModbusMasterPrivate::scheduleSend()
+{
+    Q_Q(QSerialPortModbusMaster);
+
+    // Start from the event loop, so that sendRequest() returns the id of
+    // a request before any signal reports its outcome.
+    if (sendScheduled || requestActive)
+        return;
+    sendScheduled = true;
+    QMetaObject::invokeMethod(q, [this]() {
+        sendScheduled = false;
+        sendNextRequest();
+    }, Qt::QueuedConnection);
+}
+
+void QSerialPortModbusMasterPrivate::sendNextRequest()
+{
+    while (!requestActive && !requests.isEmpty()) {
+        activeRequest = requests.takeFirst();
+        requestActive = true;
+        if (writeRequest())
+            return;
+        if (!completeRequest(QByteArray(), QSerialPortModbusMaster::WriteError))
+            return;
+    }
+}
+
+bool QSerialPortModbusMasterPrivate::writeRequest()
+{
+    if (!port || !port->isOpen())
+        return false;
+
+    QByteArray frame;
+    frame.reserve(activeRequest.pdu.size() + 3);
+    frame.append(char(activeRequest.slaveAddress));
+    frame.append(activeRequest.pdu);
+    const quint16 crc = QSerialPortModbusMaster::calculateCrc(frame);
+    frame.append(char(crc & 0xff));
+    frame.append(char(crc >> 8));
+
+    if (port->write(frame) != frame.size())
+        return false;
+    // Do not wait for the event loop to put the request on the line.
+    port->flush();
+
+    // The timer runs from now on, so add the time it takes to send the
+    // request. Broadcasts only wait for the slaves to process them.
+    const int waitTime = activeRequest.slaveAddress == broadcastAddress
+            ? turnaroundDelay : slaveTimeouts.value(activeRequest.slaveAddress, timeout);
+    timer->start(int(transmissionTime(frame.size())) + waitTime);
+    return true;
+}
+
+bool QSerialPortModbusMasterPrivate::completeRequest(const QByteArray &pdu,
+                                                     QSerialPortModbusMaster::RequestError error)
+{
+    Q_Q(QSerialPortModbusMaster);
+
+    const Request request = activeRequest;
+    activeRequest = Request();
+    requestActive = false;
+    timer->stop();
+
+    QPointer<QSerialPortModbusMaster> guard(q);
+    if (error == QSerialPortModbusMaster::NoError)
+        emit q->replyReceived(request.id, request.slaveAddress, pdu);
+    else
+        emit q->requestFailed(request.id, request.slaveAddress, error);
+    return !guard.isNull();
+}
+
+void QSerialPortModbusMasterPrivate::frameReceived(const QByteArray &frame)
+{
+    // Stray data, or a late reply to a request which timed out.
+    if (!requestActive || activeRequest.slaveAddress == broadcastAddress)
+        return;
+
+    if (frame.size() < 4) {
+        if (completeRequest(QByteArray(), QSerialPortModbusMaster::ProtocolError))
+            sendNextRequest();
+        return;
+    }
+
+    // A late reply of a slave which timed out before.
+    if (uchar(frame.at(0)) != activeRequest.slaveAddress)
+        return;
+
+    const qsizetype pduSize = frame.size() - 3;
+    const quint16 crc = quint16(uchar(frame.at(pduSize + 1)))
+            | quint16(uchar(frame.at(pduSize + 2)) << 8);
+    if (crc != QSerialPortModbusMaster::calculateCrc(QByteArrayView(frame.constData(), pduSize + 1))) {
+        if (completeRequest(QByteArray(), QSerialPortModbusMaster::CrcError))
+            sendNextRequest();
+        return;
+    }
+
+    // Exception replies carry the function code with the highest bit set.
+    const QByteArray pdu = frame.mid(1, pduSize);
+    const bool functionMatches = (uchar(pdu.at(0)) & 0x7f) == uchar(activeRequest.pdu.at(0));
+    if (completeRequest(pdu, functionMatches ? QSerialPortModbusMaster::NoError
+                                             : QSerialPortModbusMaster::ProtocolError)) {
+        // The frame was detected after the silence which has to separate
+        // it from the next one, so the bus is free right away.
+        sendNextRequest();
+    }
+}
+
+void QSerialPortModbusMasterPrivate::timerExpired()
+{
+    if (!requestActive)
+        return;
+
+    const QSerialPortModbusMaster::RequestError error =
+            activeRequest.slaveAddress == broadcastAddress
+            ? QSerialPortModbusMaster::NoError : QSerialPortModbusMaster::TimeoutError;
+    if (completeRequest(QByteArray(), error))
+        sendNextRequest();
+}
+
+/*!
+    \class QSerialPortModbusMaster
+
+    \brief Sends Modbus RTU requests over a serial port and receives the
+    replies.
+
+    \reentrant
+    \ingroup serialport-main
+    \inmodule QtSerialPort
+    \since 6.2
+
+    QSerialPortModbusMaster is the master of a Modbus RTU bus, which is
+    connected to the given QSerialPort. Requests are queued with
+    sendRequest() and sent one after the other; the outcome of each one is
+    reported by replyReceived() or requestFailed().
+
+    The frames of the slaves are detected by the silence which ends them,
+    using the framing of QSerialPort::setFrameIdleGap(). The gap is computed
+    from the baud rate, data bits, parity and stop bits of the port, and
+    updated whenever they change. The next request is sent as soon as a
+    reply is complete, so the bus is kept busy while requests are queued.
+
+    \code
+    QSerialPortModbusMaster master(&serial);
+    connect(&master, &QSerialPortModbusMaster::replyReceived,
+            this, [](quint64 id, int slaveAddress, const QByteArray &pdu) {
+        // pdu holds the function code and the data of the reply
+    });
+    for (int slave = 1; slave <= 32; ++slave)
+        master.sendRequest(slave, QByteArray::fromHex("0300000002"));
+    \endcode
+
+    The master receives all data of the port, which therefore must not be
+    read otherwise. The port has to be open for requests to be sent, and
+    its signals have to be delivered by an event loop.
+*/
+
+/*!
+    \enum QSerialPortModbusMaster::RequestError
+
+    This enum describes why a request failed.
+
+    \value NoError          No error occurred.
+    \value TimeoutError     The slave did not reply within its timeout.
+    \value CrcError         The reply had an invalid checksum.
+    \value ProtocolError    The reply was too short, or was for another
+                            function.
+    \value WriteError       The request could not be written to the port.
+*/
+
+/*!
+    \fn void QSerialPortModbusMaster::replyReceived(quint64 requestId, int slaveAddress, const QByteArray &pdu)
+
+    This signal is emitted when the slave at \a slaveAddress has replied to
+    the request with the id \a requestId. The \a pdu holds the function code
+    and the data of the reply, without the address and the checksum. For an
+    exception reply, the highest bit of the function code is set.
+
+    For broadcast requests, this signal is emitted with an empty \a pdu once
+    the turnaround delay has elapsed.
+*/
+
+/*!
+    \fn void QSerialPortModbusMaster::requestFailed(quint64 requestId, int slaveAddress, QSerialPortModbusMaster::RequestError error)
+
+    This signal is emitted when the request with the id \a requestId to the
+    slave at \a slaveAddress failed with the given \a error.
+*/
+
+/*!
+    Constructs a Modbus RTU master with the given \a parent, for the bus
+    connected to \a port.
+*/
+QSerialPortModbusMaster::QSerialPortModbusMaster(QSerialPort *port, QObject *parent)
+    : QObject(*new QSerialPortModbusMasterPrivate, parent)
+{
+    Q_D(QSerialPortModbusMaster);
+
+    d->timer = new QTimer(this);
+    d->timer->setSingleShot(true);
+    d->timer->setTimerType(Qt::PreciseTimer);
+    QObjectPrivate::connect(d->timer, &QTimer::timeout,
+                            d, &QSerialPortModbusMasterPrivate::timerExpired);
+
+    d->port = port;
+    if (!port)
+        return;
+
+    QObjectPrivate::connect(port, &QSerialPort::frameReceived,
+                            d, &QSerialPortModbusMasterPrivate::frameReceived);
+    QObjectPrivate::connect(port, &QSerialPort::baudRateChanged,
+                            d, &QSerialPortModbusMasterPrivate::updateFrameGap);
+    QObjectPrivate::connect(port, &QSerialPort::dataBitsChanged,
+                            d, &QSerialPortModbusMasterPrivate::updateFrameGap);
+    QObjectPrivate::connect(port, &QSerialPort::parityChanged,
+                            d, &QSerialPortModbusMasterPrivate::updateFrameGap);
+    QObjectPrivate::connect(port, &QSerialPort::stopBitsChanged,
+                            d, &QSerialPortModbusMasterPrivate::updateFrameGap);
+    d->updateFrameGap();
+}
+
+/*!
+    Destroys the master. Queued requests are dropped.
+*/
+QSerialPortModbusMaster::~QSerialPortModbusMaster()
+{
+}
+
+/*!
+    Returns the serial port the bus is connected to.
+*/
+QSerialPort *QSerialPortModbusMaster::port() const
+{
+    Q_D(const QSerialPortModbusMaster);
+    return d->port.data();
+}
+
+/*!
+    Returns the time to wait for a reply, in milliseconds, for slaves
+    without a timeout of their own.
+
+    \sa setTimeout(), slaveTimeout()
+*/
+int QSerialPortModbusMaster::timeout() const
+{
+    Q_D(const QSerialPortModbusMaster);
+    return d->timeout;
+}
+
+/*!
+    Sets the time to wait for a reply to \a msecs milliseconds, for slaves
+    without a timeout of their own. The default is 200 milliseconds. The
+    time it takes to send the request is added to it.
+
+    \sa timeout(), setSlaveTimeout()
+*/
+void QSerialPortModbusMaster::setTimeout(int msecs)
+{
+    Q_D(QSerialPortModbusMaster);
+    d->timeout = qMax(msecs, 0);
+}
+
+/*!
+    Returns the time to wait for a reply of the slave at \a slaveAddress,
+    in milliseconds.
+
+    \sa setSlaveTimeout(), timeout()
+*/
+int QSerialPortModbusMaster::slaveTimeout(int slaveAddress) const
+{
+    Q_D(const QSerialPortModbusMaster);
+    return d->slaveTimeouts.value(slaveAddress, d->timeout);
+}
+
+/*!
+    Sets the time to wait for a reply of the slave at \a slaveAddress to
+    \a msecs milliseconds, for example for a slow device on a bus of fast
+    ones. A negative \a msecs makes the slave use the common timeout()
+    again.
+
+    \sa slaveTimeout(), setTimeout()
+*/
+void QSerialPortModbusMaster::setSlaveTimeout(int slaveAddress, int msecs)
+{
+    Q_D(QSerialPortModbusMaster);
+    if (msecs < 0)
+        d->slaveTimeouts.remove(slaveAddress);
+    else
+        d->slaveTimeouts.insert(slaveAddress, msecs);
+}
+
+/*!
+    Returns the time given to the slaves to process a broadcast request,
+    in milliseconds.
+
+    \sa setTurnaroundDelay()
+*/
+int QSerialPortModbusMaster::turnaroundDelay() const
+{
+    Q_D(const QSerialPortModbusMaster);
+    return d->turnaroundDelay;
+}
+
+/*!
+    Sets the time given to the slaves to process a broadcast request to
+    \a msecs milliseconds. The next request is sent after this delay. The
+    default is 100 milliseconds.
+
+    \sa turnaroundDelay()
+*/
+void QSerialPortModbusMaster::setTurnaroundDelay(int msecs)
+{
+    Q_D(QSerialPortModbusMaster);
+    d->turnaroundDelay = qMax(msecs, 0);
+}
+
+/*!
+    Queues a request with the given \a pdu, the function code followed by
+    its data, for the slave at \a slaveAddress. The address \c 0 sends a
+    broadcast request to all slaves.
+
+    Returns the id of the request, which identifies it in the
+    replyReceived() and requestFailed() signals, or \c 0 if the address or
+    the size of the \a pdu is invalid.
+*/
+quint64 QSerialPortModbusMaster::sendRequest(int slaveAddress, const QByteArray &pdu)
+{
+    Q_D(QSerialPortModbusMaster);
+
+    if (slaveAddress < broadcastAddress || slaveAddress > maximumSlaveAddress
+            || pdu.isEmpty() || pdu.size() > maximumPduSize) {
+        return 0;
+    }
+
+    QSerialPortModbusMasterPrivate::Request request;
+    request.id = d->nextRequestId++;
+    request.slaveAddress = slaveAddress;
+    request.pdu = pdu;
+    d->requests.append(request);
+    d->scheduleSend();
+    return request.id;
+}
+
+/*!
+    Returns the number of requests which have not completed yet, including
+    the one in progress.
+*/
+qsizetype QSerialPortModbusMaster::pendingRequestCount() const
+{
+    Q_D(const QSerialPortModbusMaster);
+    return d->requests.size() + (d->requestActive ? 1 : 0);
+}
+
+/*!
+    Drops all queued requests. The request in progress, if any, still
+    completes.
+*/
+void QSerialPortModbusMaster::clearRequests()
+{
+    Q_D(QSerialPortModbusMaster);
+    d->requests.clear();
+}
+
+/*!
+    Returns the Modbus CRC-16 of \a data. In an RTU frame, the CRC follows
+    the data with its low byte first.
+*/
+quint16 QSerialPortModbusMaster::calculateCrc(QByteArrayView data)
+{
+    quint16 crc = 0xffff;
+    for (const char byte : data)
+        crc = quint16((crc >> 8) ^ modbusCrcTable.values[(crc ^ uchar(byte)) & 0xff]);
+    return crc;
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qserialportmodbusmaster.cpp"
@@ -0,0 +1,134 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtSerialPort module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QSERIALPORTREADTHREAD_P_H
+#define QSERIALPORTREADTHREAD_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qserialportstatistics_p.h"
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qthread.h>
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+// A single producer, single consumer ring of bytes. The producer fills
+// the span returned by writePointer() and publishes it with commit(), the
+// consumer processes the span returned by readPointer() and frees it with
+// release(). size() and isEmpty() may be called from either side.
+class QSerialPortReadRing
+{
+public:
+    explicit QSerialPortReadRing(qint64 capacity);
+
+    qint64 capacity() const { return qint64(mask) + 1; }
+    qint64 size() const;
+    bool isEmpty() const { return size() == 0; }
+
+    char *writePointer(qint64 *length);
+    void commit(qint64 length);
+
+    const char *readPointer(qint64 *length) const;
+    void release(qint64 length);
+
+private:
+    std::unique_ptr<char[]> storage;
+    quintptr mask = 0;
+
+    // Keep the indexes of both sides on separate cache lines.
+    alignas(64) QAtomicInteger<quintptr> head; // Written by the producer.
+    alignas(64) QAtomicInteger<quintptr> tail; // Written by the consumer.
+};
+
+// Reads the port in its own thread into a QSerialPortReadRing. The owner
+// thread is notified through a pipe, which is written only once until
+// acknowledgeNotification() is called, so that notifications coalesce.
+class QSerialPortReadThread : public QThread
+{
+public:
+    QSerialPortReadThread(int descriptor, qint64 bufferSize,
+                          QSerialPortStatisticsCounters *statistics = nullptr);
+    ~QSerialPortReadThread();
+
+    bool isValid() const;
+
+    int notificationDescriptor() const { return notificationPipe[0]; }
+    QSerialPortReadRing &ring() { return readRing; }
+
+    void acknowledgeNotification();
+    void requestNotification();
+    void resumeReading();
+
+    int errorCode() const { return readErrorCode.loadAcquire(); }
+
+protected:
+    void run() override;
+
+private:
+    void notify();
+    void wakeUp();
+
+    const int descriptor;
+    QSerialPortReadRing readRing;
+    QSerialPortStatisticsCounters *const statistics;
+
+    int notificationPipe[2] = { -1, -1 };
+    int wakeUpPipe[2] = { -1, -1 };
+
+    QAtomicInt notificationPending;
+    QAtomicInt readingSuspended;
+    QAtomicInt stopRequested;
+    QAtomicInt readErrorCode;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSERIALPORTREADTHREAD_P_H
@@ -0,0 +1,226 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtSerialPort module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qserialportreadthread_p.h"
+
+#include <QtCore/qmath.h>
+
+#include <private/qcore_unix_p.h>
+
+#include <errno.h>
+#include <fcntl.h>
+
+QT_BEGIN_NAMESPACE
+
+static const qint64 minimumReadRingCapacity = 4096;
+static const qint64 maximumReadRingCapacity = 1024 * 1024 * 1024;
+
+QSerialPortReadRing::QSerialPortReadRing(qint64 capacity)
+{
+    // A power of two keeps the free running indexes valid across overflow.
+    capacity = qBound(minimumReadRingCapacity, capacity, maximumReadRingCapacity);
+    mask = quintptr(qNextPowerOfTwo(quint32(capacity - 1))) - 1;
+    storage.reset(new char[mask + 1]);
+}
+
+qint64 QSerialPortReadRing::size() const
+{
+    return qint64(head.loadAcquire() - tail.loadAcquire());
+}
+
+char *QSerialPortReadRing::writePointer(qint64 *length)
+{
+    const quintptr writeIndex = head.loadRelaxed();
+    const quintptr freeBytes = mask + 1 - (writeIndex - tail.loadAcquire());
+    const quintptr offset = writeIndex & mask;
+    *length = qint64(qMin(freeBytes, mask + 1 - offset));
+    return storage.get() + offset;
+}
+
+void QSerialPortReadRing::commit(qint64 length)
+{
+    head.storeRelease(head.loadRelaxed() + quintptr(length));
+}
+
+const char *QSerialPortReadRing::readPointer(qint64 *length) const
+{
+    const quintptr readIndex = tail.loadRelaxed();
+    const quintptr usedBytes = head.loadAcquire() - readIndex;
+    const quintptr offset = readIndex & mask;
+    *length = qint64(qMin(usedBytes, mask + 1 - offset));
+    return storage.get() + offset;
+}
+
+void QSerialPortReadRing::release(qint64 length)
+{
+    tail.storeRelease(tail.loadRelaxed() + quintptr(length));
+}
+
+static void drainPipe(int descriptor)
+{
+    char data[64];
+    while (qt_safe_read(descriptor, data, sizeof(data)) > 0)
+        ;
+}
+
+QSerialPortReadThread::QSerialPortReadThread(int descriptor, qint64 bufferSize,
+                                             QSerialPortStatisticsCounters *statistics)
+    : descriptor(descriptor)
+    , readRing(bufferSize)
+    , statistics(statistics)
+{
+    if (qt_safe_pipe(notificationPipe, O_NONBLOCK) == -1)
+        notificationPipe[0] = notificationPipe[1] = -1;
+    if (qt_safe_pipe(wakeUpPipe, O_NONBLOCK) == -1)
+        wakeUpPipe[0] = wakeUpPipe[1] = -1;
+}
+
+QSerialPortReadThread::~QSerialPortReadThread()
+{
+    if (isRunning()) {
+        stopRequested.storeRelease(1);
+        wakeUp();
+        wait();
+    }
+
+    for (int pipeDescriptor : { notificationPipe[0], notificationPipe[1],
+                                wakeUpPipe[0], wakeUpPipe[1] }) {
+        if (pipeDescriptor != -1)
+            qt_safe_close(pipeDescriptor);
+    }
+}
+
+bool QSerialPortReadThread::isValid() const
+{
+    return notificationPipe[0] != -1 && wakeUpPipe[0] != -1;
+}
+
+void QSerialPortReadThread::acknowledgeNotification()
+{
+    // Clear the flag only after draining the pipe, data committed later
+    // writes the pipe again.
+    drainPipe(notificationPipe[0]);
+    notificationPending.storeRelease(0);
+}
+
+void QSerialPortReadThread::requestNotification()
+{
+    if (!readRing.isEmpty() || errorCode() != 0)
+        notify();
+}
+
+void QSerialPortReadThread::resumeReading()
+{
+    if (readingSuspended.fetchAndStoreOrdered(0))
+        wakeUp();
+}
+
+void QSerialPortReadThread::notify()
+{
+    if (!notificationPending.fetchAndStoreOrdered(1)) {
+        const char c = 0;
+        qt_safe_write(notificationPipe[1], &c, 1);
+    }
+}
+
+void QSerialPortReadThread::wakeUp()
+{
+    const char c = 0;
+    qt_safe_write(wakeUpPipe[1], &c, 1);
+}
+
+void QSerialPortReadThread::run()
+{
+    for (;;) {
+        qint64 length = 0;
+        char *data = readRing.writePointer(&length);
+        if (length == 0) {
+            // The ring is full, wait until the consumer has released some
+            // space. Check again after announcing it, so that no wake up
+            // can be missed.
+            readingSuspended.fetchAndStoreOrdered(1);
+            data = readRing.writePointer(&length);
+        }
+
+        pollfd pfds[2] = {
+            qt_make_pollfd(wakeUpPipe[0], POLLIN),
+            qt_make_pollfd(length > 0 ? descriptor : -1, POLLIN)
+        };
+
+        if (qt_poll_msecs(pfds, 2, -1) < 0) {
+            readErrorCode.storeRelease(errno);
+            notify();
+            return;
+        }
+
+        if (pfds[0].revents & POLLIN) {
+            drainPipe(wakeUpPipe[0]);
+            if (stopRequested.loadAcquire())
+                return;
+        }
+
+        if (pfds[1].revents & POLLNVAL) {
+            readErrorCode.storeRelease(EBADF);
+            notify();
+            return;
+        }
+
+        if (!(pfds[1].revents & (POLLIN | POLLHUP | POLLERR)))
+            continue;
+
+        const qint64 readBytes = qt_safe_read(descriptor, data, length);
+        if (statistics && (readBytes >= 0 || errno == EAGAIN))
+            statistics->recordRead(readBytes);
+        if (readBytes > 0) {
+            readRing.commit(readBytes);
+            notify();
+        } else if (readBytes < 0 && errno != EAGAIN) {
+            readErrorCode.storeRelease(errno);
+            notify();
+            return;
+        } else if (readBytes == 0 && (pfds[1].revents & (POLLHUP | POLLERR))) {
+            // The device is gone.
+            readErrorCode.storeRelease(EIO);
+            notify();
+            return;
+        }
+    }
+}
+
+QT_END_NAMESPACE
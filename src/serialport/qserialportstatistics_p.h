@@ -0,0 +1,171 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtSerialPort module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QSERIALPORTSTATISTICS_P_H
+#define QSERIALPORTSTATISTICS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qserialport.h"
+
+#include <QtCore/qatomic.h>
+
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+// The counters behind QSerialPort::statistics(). They are updated on every
+// transfer, so all updates are relaxed atomic operations without locks; the
+// read thread updates the read counters concurrently with the owner thread.
+class QSerialPortStatisticsCounters
+{
+public:
+    QSerialPortStatisticsCounters() { reset(); }
+
+    void recordRead(qint64 bytes)
+    {
+        if (bytes <= 0) {
+            emptyReadCalls.fetchAndAddRelaxed(1);
+            return;
+        }
+        readCalls.fetchAndAddRelaxed(1);
+        bytesRead.fetchAndAddRelaxed(bytes);
+        updateMinimum(minimumBytesPerRead, bytes);
+        updateMaximum(maximumBytesPerRead, bytes);
+    }
+
+    void recordWrite(qint64 bytes)
+    {
+        if (bytes <= 0)
+            return;
+        writeCalls.fetchAndAddRelaxed(1);
+        bytesWritten.fetchAndAddRelaxed(bytes);
+        updateMinimum(minimumBytesPerWrite, bytes);
+        updateMaximum(maximumBytesPerWrite, bytes);
+    }
+
+    void recordReadyRead() { readyReadSignals.fetchAndAddRelaxed(1); }
+    void recordBytesWritten() { bytesWrittenSignals.fetchAndAddRelaxed(1); }
+
+    void recordReadBufferSize(qint64 size) { updateMaximum(readBufferHighWaterMark, size); }
+    void recordWriteBufferSize(qint64 size) { updateMaximum(writeBufferHighWaterMark, size); }
+
+    QSerialPort::Statistics snapshot() const
+    {
+        QSerialPort::Statistics statistics;
+        statistics.readCalls = readCalls.loadRelaxed();
+        statistics.emptyReadCalls = emptyReadCalls.loadRelaxed();
+        statistics.bytesRead = bytesRead.loadRelaxed();
+        statistics.minimumBytesPerRead = minimumOrZero(minimumBytesPerRead);
+        statistics.maximumBytesPerRead = maximumBytesPerRead.loadRelaxed();
+        statistics.writeCalls = writeCalls.loadRelaxed();
+        statistics.bytesWritten = bytesWritten.loadRelaxed();
+        statistics.minimumBytesPerWrite = minimumOrZero(minimumBytesPerWrite);
+        statistics.maximumBytesPerWrite = maximumBytesPerWrite.loadRelaxed();
+        statistics.readyReadSignals = readyReadSignals.loadRelaxed();
+        statistics.bytesWrittenSignals = bytesWrittenSignals.loadRelaxed();
+        statistics.readBufferHighWaterMark = readBufferHighWaterMark.loadRelaxed();
+        statistics.writeBufferHighWaterMark = writeBufferHighWaterMark.loadRelaxed();
+        return statistics;
+    }
+
+    void reset()
+    {
+        for (QAtomicInteger<qint64> *counter : { &readCalls, &emptyReadCalls, &bytesRead,
+                                                 &maximumBytesPerRead, &writeCalls,
+                                                 &bytesWritten, &maximumBytesPerWrite,
+                                                 &readyReadSignals, &bytesWrittenSignals,
+                                                 &readBufferHighWaterMark,
+                                                 &writeBufferHighWaterMark }) {
+            counter->storeRelaxed(0);
+        }
+        minimumBytesPerRead.storeRelaxed(noMinimum);
+        minimumBytesPerWrite.storeRelaxed(noMinimum);
+    }
+
+private:
+    static constexpr qint64 noMinimum = std::numeric_limits<qint64>::max();
+
+    static void updateMinimum(QAtomicInteger<qint64> &counter, qint64 value)
+    {
+        qint64 current = counter.loadRelaxed();
+        while (value < current && !counter.testAndSetRelaxed(current, value, current))
+            ;
+    }
+
+    static void updateMaximum(QAtomicInteger<qint64> &counter, qint64 value)
+    {
+        qint64 current = counter.loadRelaxed();
+        while (value > current && !counter.testAndSetRelaxed(current, value, current))
+            ;
+    }
+
+    static qint64 minimumOrZero(const QAtomicInteger<qint64> &counter)
+    {
+        const qint64 value = counter.loadRelaxed();
+        return value == noMinimum ? 0 : value;
+    }
+
+    QAtomicInteger<qint64> readCalls;
+    QAtomicInteger<qint64> emptyReadCalls;
+    QAtomicInteger<qint64> bytesRead;
+    QAtomicInteger<qint64> minimumBytesPerRead;
+    QAtomicInteger<qint64> maximumBytesPerRead;
+    QAtomicInteger<qint64> writeCalls;
+    QAtomicInteger<qint64> bytesWritten;
+    QAtomicInteger<qint64> minimumBytesPerWrite;
+    QAtomicInteger<qint64> maximumBytesPerWrite;
+    QAtomicInteger<qint64> readyReadSignals;
+    QAtomicInteger<qint64> bytesWrittenSignals;
+    QAtomicInteger<qint64> readBufferHighWaterMark;
+    QAtomicInteger<qint64> writeBufferHighWaterMark;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSERIALPORTSTATISTICS_P_H
@@ -0,0 +1,782 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtSerialPort module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qserialportvirtualpair.h"
+#include "qserialportvirtualpair_p.h"
+
+#ifdef Q_OS_UNIX
+#include "qserialport_p.h"
+
+#include <QtCore/qdeadlinetimer.h>
+
+#include <private/qcore_unix_p.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#endif
+
+QT_BEGIN_NAMESPACE
+
+#ifdef Q_OS_UNIX
+// How often the line settings are compared while nothing is transferred,
+// in nanoseconds.
+static const qint64 settingsPollInterval = 20 * 1000 * 1000;
+
+// The data read ahead from a sender that has not been delivered yet.
+static const qint64 maximumPendingSize = 64 * 1024;
+
+// A simulated transmitter holds at least a 16 character FIFO worth of data,
+// or 2 ms, so that the relay does not have to wake up for every character.
+static const qint64 transmitQueueMinimumSize = 16;
+static const qint64 transmitQueueMinimumTime = 2 * 1000 * 1000;
+
+// The termios flags which describe the line rather than the local
+// processing of the data.
+static const tcflag_t lineControlFlags = CSIZE | PARENB | PARODD | CSTOPB
+#ifdef CRTSCTS
+        | CRTSCTS
+#endif
+#ifdef CMSPAR
+        | CMSPAR
+#endif
+        ;
+static const tcflag_t lineInputFlags = INPCK | IGNPAR | PARMRK | IXON | IXOFF | IXANY;
+
+static qint64 currentTime()
+{
+    return QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+}
+
+static int characterDataBits(const termios &tio)
+{
+    switch (tio.c_cflag & CSIZE) {
+    case CS5:
+        return 5;
+    case CS6:
+        return 6;
+    case CS7:
+        return 7;
+    default:
+        return 8;
+    }
+}
+
+static bool isSameLine(const termios &first, const termios &second)
+{
+    return (first.c_cflag & lineControlFlags) == (second.c_cflag & lineControlFlags)
+            && (first.c_iflag & lineInputFlags) == (second.c_iflag & lineInputFlags)
+            && ::cfgetispeed(&first) == ::cfgetispeed(&second)
+            && ::cfgetospeed(&first) == ::cfgetospeed(&second);
+}
+
+QSerialPortVirtualPairRelay::QSerialPortVirtualPairRelay(QSerialPortVirtualPair *pair,
+                                                         const int masters[2],
+                                                         const int slaves[2],
+                                                         const QString portNames[2])
+    : pair(pair)
+    , settingsMirroringEnabled(1)
+{
+    for (int i = 0; i < 2; ++i) {
+        this->slaves[i] = slaves[i];
+        this->portNames[i] = portNames[i];
+        directions[i].from = masters[i];
+        directions[i].to = masters[1 - i];
+        directions[i].sendingSlave = slaves[i];
+        ::memset(&lineSettings[i], 0, sizeof(termios));
+        ::tcgetattr(slaves[i], &lineSettings[i]);
+    }
+
+    if (qt_safe_pipe(wakeUpPipe, O_NONBLOCK) == -1)
+        wakeUpPipe[0] = wakeUpPipe[1] = -1;
+}
+
+QSerialPortVirtualPairRelay::~QSerialPortVirtualPairRelay()
+{
+    if (isRunning()) {
+        stopRequested.storeRelease(1);
+        wakeUp();
+        wait();
+    }
+
+    for (int pipeDescriptor : wakeUpPipe) {
+        if (pipeDescriptor != -1)
+            qt_safe_close(pipeDescriptor);
+    }
+}
+
+void QSerialPortVirtualPairRelay::setSettingsMirroringEnabled(bool enable)
+{
+    settingsMirroringEnabled.storeRelaxed(enable ? 1 : 0);
+    wakeUp();
+}
+
+void QSerialPortVirtualPairRelay::wakeUp()
+{
+    const char c = 0;
+    qt_safe_write(wakeUpPipe[1], &c, 1);
+}
+
+void QSerialPortVirtualPairRelay::setLinkSimulation(
+        bool enable, const QSerialPortVirtualPair::LinkSimulation &simulation)
+{
+    {
+        QMutexLocker locker(&linkSimulationMutex);
+        linkSimulationEnabled = enable;
+        linkSimulation = simulation;
+        linkSimulationChanged = true;
+    }
+    wakeUp();
+}
+
+qint64 QSerialPortVirtualPairRelay::lineCharacterTime(int slave) const
+{
+    termios tio;
+    if (::tcgetattr(slave, &tio) == -1)
+        return 0;
+
+    // Custom baud rates are not known here, such a line is not throttled.
+    // The data bits and parity are those of the pseudo-terminal, which on
+    // Linux are always 8 without parity.
+    const qint32 baudRate = QSerialPortPrivate::baudRateFromSetting(qint32(::cfgetospeed(&tio)));
+    if (baudRate <= 0)
+        return 0;
+
+    int bits = 1 + characterDataBits(tio);
+    if (tio.c_cflag & PARENB)
+        ++bits;
+    bits += (tio.c_cflag & CSTOPB) ? 2 : 1;
+    return bits * qint64(1000000000) / baudRate;
+}
+
+void QSerialPortVirtualPairRelay::corrupt(QByteArray *data, int dataBits)
+{
+    if (simulation.bitErrorRate <= 0 && simulation.overrunRate <= 0)
+        return;
+
+    const double byteErrorRate = simulation.bitErrorRate > 0
+            ? 1 - std::pow(1 - qMin(simulation.bitErrorRate, 1.0), dataBits) : 0;
+
+    qsizetype size = 0;
+    for (qsizetype i = 0; i < data->size(); ++i) {
+        // The receiver loses the characters it has no time to pick up.
+        if (simulation.overrunRate > 0 && random.generateDouble() < simulation.overrunRate)
+            continue;
+        char c = data->at(i);
+        if (byteErrorRate > 0 && random.generateDouble() < byteErrorRate)
+            c ^= char(1 << random.bounded(dataBits));
+        (*data)[size++] = c;
+    }
+    data->truncate(size);
+}
+
+bool QSerialPortVirtualPairRelay::receive(Direction *direction, qint64 now)
+{
+    char buffer[4096];
+    qint64 maximumSize = sizeof(buffer);
+
+    const qint64 characterTime = simulating ? lineCharacterTime(direction->sendingSlave) : 0;
+    direction->transmitQueueTime = 0;
+    if (characterTime > 0) {
+        // Take over as much as a transmitter queue holds, so that the
+        // sender has to wait for the line.
+        direction->transmitQueueTime = qMax(transmitQueueMinimumTime,
+                                            transmitQueueMinimumSize * characterTime);
+        const qint64 queueTime = qMax(direction->transmitterFreeAt - now, qint64(0));
+        maximumSize = qBound(qint64(1), (direction->transmitQueueTime - queueTime) / characterTime,
+                             maximumSize);
+    }
+
+    const qint64 readBytes = qt_safe_read(direction->from, buffer, maximumSize);
+    if (readBytes < 0)
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    if (readBytes == 0)
+        return true;
+
+    WireChunk chunk = { QByteArray(buffer, readBytes), 0, 0 };
+    if (simulating) {
+        termios tio;
+        const int dataBits = ::tcgetattr(direction->sendingSlave, &tio) == 0
+                ? characterDataBits(tio) : 8;
+        corrupt(&chunk.data, dataBits);
+
+        const qint64 start = qMax(now, direction->transmitterFreeAt);
+        direction->transmitterFreeAt = start + readBytes * characterTime;
+
+        qint64 delay = qint64(simulation.latency) * 1000;
+        if (simulation.jitter > 0)
+            delay += qint64(random.bounded(simulation.jitter + 1)) * 1000;
+        // Jitter delays the data, but never reorders it.
+        chunk.firstArrival = qMax(start + characterTime + delay, direction->lastArrival);
+        chunk.characterTime = characterTime;
+        direction->lastArrival = chunk.firstArrival
+                + qMax(chunk.data.size() - 1, qsizetype(0)) * characterTime;
+    }
+
+    if (!chunk.data.isEmpty()) {
+        direction->pendingBytes += chunk.data.size();
+        direction->wire.append(std::move(chunk));
+    }
+    return true;
+}
+
+qint64 QSerialPortVirtualPairRelay::nextArrival(const Direction &direction)
+{
+    if (direction.wire.isEmpty())
+        return std::numeric_limits<qint64>::max();
+    const WireChunk &chunk = direction.wire.constFirst();
+    return chunk.firstArrival + direction.delivered * chunk.characterTime;
+}
+
+bool QSerialPortVirtualPairRelay::deliver(Direction *direction, qint64 now)
+{
+    while (!direction->wire.isEmpty()) {
+        const WireChunk &chunk = direction->wire.constFirst();
+        if (now < chunk.firstArrival)
+            return true;
+
+        qint64 arrived = chunk.data.size();
+        if (chunk.characterTime > 0)
+            arrived = qMin(arrived, (now - chunk.firstArrival) / chunk.characterTime + 1);
+        const qint64 length = arrived - direction->delivered;
+        if (length <= 0)
+            return true;
+
+        const qint64 written = qt_safe_write(direction->to,
+                                             chunk.data.constData() + direction->delivered,
+                                             length);
+        if (written < 0)
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+
+        direction->delivered += written;
+        direction->pendingBytes -= written;
+        if (direction->delivered == chunk.data.size()) {
+            direction->wire.removeFirst();
+            direction->delivered = 0;
+        } else if (written < length) {
+            return true;
+        }
+    }
+    return true;
+}
+
+void QSerialPortVirtualPairRelay::mirrorSettings()
+{
+    termios current[2];
+    for (int i = 0; i < 2; ++i) {
+        if (::tcgetattr(slaves[i], &current[i]) == -1)
+            return;
+    }
+
+    // If both sides changed at once, the first one wins.
+    for (int from = 0; from < 2; ++from) {
+        if (isSameLine(current[from], lineSettings[from]))
+            continue;
+
+        const int to = 1 - from;
+        termios mirrored = current[to];
+        mirrored.c_cflag = (mirrored.c_cflag & ~lineControlFlags)
+                | (current[from].c_cflag & lineControlFlags);
+        mirrored.c_iflag = (mirrored.c_iflag & ~lineInputFlags)
+                | (current[from].c_iflag & lineInputFlags);
+        ::cfsetispeed(&mirrored, ::cfgetispeed(&current[from]));
+        ::cfsetospeed(&mirrored, ::cfgetospeed(&current[from]));
+
+        if (!isSameLine(mirrored, current[to])
+                && ::tcsetattr(slaves[to], TCSANOW, &mirrored) == 0) {
+            current[to] = mirrored;
+            QMetaObject::invokeMethod(pair, [pair = pair, fromName = portNames[from],
+                                             toName = portNames[to]]() {
+                emit pair->settingsMirrored(fromName, toName);
+            }, Qt::QueuedConnection);
+        }
+        break;
+    }
+
+    lineSettings[0] = current[0];
+    lineSettings[1] = current[1];
+}
+
+void QSerialPortVirtualPairRelay::run()
+{
+    while (!stopRequested.loadAcquire()) {
+        {
+            QMutexLocker locker(&linkSimulationMutex);
+            if (linkSimulationChanged) {
+                linkSimulationChanged = false;
+                simulating = linkSimulationEnabled;
+                simulation = linkSimulation;
+                random.seed(simulation.seed);
+            }
+        }
+
+        const bool mirroring = settingsMirroringEnabled.loadRelaxed();
+        qint64 now = currentTime();
+        qint64 wakeUpTime = mirroring ? now + settingsPollInterval
+                                      : std::numeric_limits<qint64>::max();
+
+        pollfd pfds[5] = { qt_make_pollfd(wakeUpPipe[0], POLLIN) };
+        for (int i = 0; i < 2; ++i) {
+            const Direction &direction = directions[i];
+
+            bool canReceive = direction.pendingBytes < maximumPendingSize;
+            if (canReceive && simulating
+                    && direction.transmitterFreeAt - now > direction.transmitQueueTime) {
+                canReceive = false;
+                wakeUpTime = qMin(wakeUpTime,
+                                  direction.transmitterFreeAt - direction.transmitQueueTime);
+            }
+            pfds[1 + i] = qt_make_pollfd(direction.from, canReceive ? POLLIN : 0);
+
+            // Wait for room at the receiver, or for the next byte to arrive.
+            const qint64 arrival = nextArrival(direction);
+            pfds[3 + i] = qt_make_pollfd(direction.to, arrival <= now ? POLLOUT : 0);
+            if (arrival > now)
+                wakeUpTime = qMin(wakeUpTime, arrival);
+        }
+
+        timespec timeout;
+        if (wakeUpTime != std::numeric_limits<qint64>::max()) {
+            const qint64 remaining = qMax(wakeUpTime - now, qint64(0));
+            timeout.tv_sec = remaining / 1000000000;
+            timeout.tv_nsec = remaining % 1000000000;
+        }
+        if (qt_safe_poll(pfds, 5, wakeUpTime != std::numeric_limits<qint64>::max()
+                         ? &timeout : nullptr) < 0) {
+            return;
+        }
+
+        if (pfds[0].revents & POLLIN) {
+            char data[64];
+            while (qt_safe_read(wakeUpPipe[0], data, sizeof(data)) > 0)
+                ;
+        }
+
+        now = currentTime();
+        for (int i = 0; i < 2; ++i) {
+            if ((pfds[1 + i].revents & (POLLIN | POLLHUP | POLLERR))
+                    && !receive(&directions[i], now)) {
+                return;
+            }
+            if (!deliver(&directions[i], now))
+                return;
+        }
+
+        if (mirroring)
+            mirrorSettings();
+    }
+}
+#endif
+
+QSerialPortVirtualPairPrivate::QSerialPortVirtualPairPrivate()
+{
+}
+
+void QSerialPortVirtualPairPrivate::destroyPair()
+{
+#ifdef Q_OS_UNIX
+    delete relay;
+    relay = nullptr;
+
+    for (int *descriptor : { &masters[0], &masters[1], &slaves[0], &slaves[1] }) {
+        if (*descriptor != -1) {
+            qt_safe_close(*descriptor);
+            *descriptor = -1;
+        }
+    }
+#endif
+}
+
+bool QSerialPortVirtualPairPrivate::createPair()
+{
+#ifdef Q_OS_UNIX
+    Q_Q(QSerialPortVirtualPair);
+
+    for (int i = 0; i < 2; ++i) {
+        masters[i] = ::posix_openpt(O_RDWR | O_NOCTTY);
+        const char *name = nullptr;
+        if (masters[i] == -1 || ::grantpt(masters[i]) == -1 || ::unlockpt(masters[i]) == -1
+                || (name = ::ptsname(masters[i])) == nullptr) {
+            errorString = qt_error_string(errno);
+            return false;
+        }
+        // The short name, as QSerialPort::portName() reports it.
+        portNames[i] = QSerialPortPrivate::portNameFromSystemLocation(QString::fromLocal8Bit(name));
+        ::fcntl(masters[i], F_SETFD, FD_CLOEXEC);
+        ::fcntl(masters[i], F_SETFL, ::fcntl(masters[i], F_GETFL) | O_NONBLOCK);
+
+        slaves[i] = qt_safe_open(name, O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (slaves[i] == -1) {
+            errorString = qt_error_string(errno);
+            return false;
+        }
+
+        // Nothing may be echoed or translated until a QSerialPort has
+        // configured the port, as with a real line.
+        termios tio;
+        if (::tcgetattr(slaves[i], &tio) == 0) {
+            ::cfmakeraw(&tio);
+            ::tcsetattr(slaves[i], TCSANOW, &tio);
+        }
+    }
+
+    std::unique_ptr<QSerialPortVirtualPairRelay> newRelay(
+                new QSerialPortVirtualPairRelay(q, masters, slaves, portNames));
+    if (!newRelay->isValid()) {
+        errorString = qt_error_string(errno);
+        return false;
+    }
+
+    newRelay->setObjectName(QLatin1String("QSerialPortVirtualPair relay"));
+    newRelay->start();
+    relay = newRelay.release();
+    return true;
+#else
+    errorString = QSerialPortVirtualPair::tr("Virtual serial port pairs are not supported on this platform");
+    return false;
+#endif
+}
+
+/*!
+    \class QSerialPortVirtualPair
+
+    \brief Creates two connected virtual serial ports.
+
+    \reentrant
+    \ingroup serialport-main
+    \inmodule QtSerialPort
+    \since 6.2
+
+    QSerialPortVirtualPair behaves like two serial ports connected by a
+    null-modem cable. Each port is the slave side of a pseudo-terminal,
+    which QSerialPort opens by the name returned by firstPortName() or
+    secondPortName(). A thread relays the data written to one port to the
+    other one for as long as the pair exists.
+
+    \code
+    QSerialPortVirtualPair pair;
+    QSerialPort sender(pair.firstPortName());
+    QSerialPort receiver(pair.secondPortName());
+    sender.open(QIODevice::WriteOnly);
+    receiver.open(QIODevice::ReadOnly);
+    \endcode
+
+    This allows testing serial communication without hardware. By default,
+    the data is transferred as fast as the pseudo-terminals allow,
+    regardless of the baud rate. The link simulation paces it like a real
+    line instead, see setLinkSimulationEnabled(). The modem control lines,
+    such as RTS and DTR, and break conditions are not supported by
+    pseudo-terminals.
+
+    With settings mirroring, which is enabled by default, a change of the
+    line settings of one port is applied to the other port as well, and
+    reported by the settingsMirrored() signal. A QSerialPort that has the
+    other port open does not update its properties.
+
+    \note On Linux, pseudo-terminals always use 8 data bits without parity,
+    whatever is set on them. A QSerialPort still reports the data bits and
+    parity set on it, but only the baud rate, stop bits and flow control
+    reach the other port.
+
+    \note QSerialPortVirtualPair is only supported on Unix.
+*/
+
+/*!
+    \class QSerialPortVirtualPair::LinkSimulation
+    \inmodule QtSerialPort
+    \since 6.2
+
+    \brief The LinkSimulation struct holds the impairments of a simulated
+    serial line.
+
+    \sa setLinkSimulation()
+*/
+
+/*!
+    \variable QSerialPortVirtualPair::LinkSimulation::latency
+
+    The delay, in microseconds, added to the wire time of every chunk of
+    data, as caused by USB adapters that poll their UART. The default is 0.
+*/
+
+/*!
+    \variable QSerialPortVirtualPair::LinkSimulation::jitter
+
+    The maximum random delay, in microseconds, added to the latency of
+    every chunk of data. The data is never reordered. The default is 0.
+*/
+
+/*!
+    \variable QSerialPortVirtualPair::LinkSimulation::bitErrorRate
+
+    The probability of every data bit to be flipped on the line. The
+    default is 0.
+*/
+
+/*!
+    \variable QSerialPortVirtualPair::LinkSimulation::overrunRate
+
+    The probability of every character to be lost by the receiver, as in
+    a hardware overrun. The default is 0.
+*/
+
+/*!
+    \variable QSerialPortVirtualPair::LinkSimulation::seed
+
+    The seed of the random numbers used for the jitter and the errors. The
+    same seed gives the same impairments for the same data. The default
+    is 1.
+*/
+
+/*!
+    \fn void QSerialPortVirtualPair::settingsMirrored(const QString &fromPortName, const QString &toPortName)
+
+    This signal is emitted after the line settings of the port
+    \a fromPortName have been applied to the port \a toPortName.
+
+    \sa setSettingsMirroringEnabled()
+*/
+
+/*!
+    Constructs a virtual serial port pair with the given \a parent.
+
+    \sa isValid()
+*/
+QSerialPortVirtualPair::QSerialPortVirtualPair(QObject *parent)
+    : QObject(*new QSerialPortVirtualPairPrivate, parent)
+{
+    Q_D(QSerialPortVirtualPair);
+    d->createPair();
+}
+
+/*!
+    Destroys the pair. Ports that are still open report an error on their
+    next access.
+*/
+QSerialPortVirtualPair::~QSerialPortVirtualPair()
+{
+    Q_D(QSerialPortVirtualPair);
+    // The relay posts signal emissions to the pair, so it has to stop
+    // while the pair is still whole.
+    d->destroyPair();
+}
+
+/*!
+    Returns \c true if virtual serial port pairs are supported on this
+    platform; otherwise returns \c false.
+*/
+bool QSerialPortVirtualPair::isSupported()
+{
+#ifdef Q_OS_UNIX
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*!
+    Returns \c true if the pair has been created; otherwise returns
+    \c false.
+
+    \sa errorString()
+*/
+bool QSerialPortVirtualPair::isValid() const
+{
+#ifdef Q_OS_UNIX
+    Q_D(const QSerialPortVirtualPair);
+    return d->relay != nullptr;
+#else
+    return false;
+#endif
+}
+
+/*!
+    Returns a description of the error that prevented creating the pair.
+
+    \sa isValid()
+*/
+QString QSerialPortVirtualPair::errorString() const
+{
+    Q_D(const QSerialPortVirtualPair);
+    return d->errorString;
+}
+
+/*!
+    Returns the name of the first port of the pair, in the form that
+    QSerialPort::portName() returns, such as \c pts/3.
+
+    \sa secondPortName()
+*/
+QString QSerialPortVirtualPair::firstPortName() const
+{
+    Q_D(const QSerialPortVirtualPair);
+    return d->portNames[0];
+}
+
+/*!
+    Returns the name of the second port of the pair, in the form that
+    QSerialPort::portName() returns, such as \c pts/4.
+
+    \sa firstPortName()
+*/
+QString QSerialPortVirtualPair::secondPortName() const
+{
+    Q_D(const QSerialPortVirtualPair);
+    return d->portNames[1];
+}
+
+/*!
+    Returns \c true if the line settings are mirrored between the ports;
+    otherwise returns \c false.
+
+    \sa setSettingsMirroringEnabled()
+*/
+bool QSerialPortVirtualPair::isSettingsMirroringEnabled() const
+{
+    Q_D(const QSerialPortVirtualPair);
+    return d->settingsMirroringEnabled;
+}
+
+/*!
+    Enables mirroring the line settings between the ports if \a enable is
+    \c true. The default is \c true.
+
+    The settings of both ports are checked regularly while mirroring is
+    enabled, so a change is applied to the other port within a few tens of
+    milliseconds.
+
+    \sa isSettingsMirroringEnabled(), settingsMirrored()
+*/
+void QSerialPortVirtualPair::setSettingsMirroringEnabled(bool enable)
+{
+    Q_D(QSerialPortVirtualPair);
+
+    d->settingsMirroringEnabled = enable;
+#ifdef Q_OS_UNIX
+    if (d->relay)
+        d->relay->setSettingsMirroringEnabled(enable);
+#endif
+}
+
+/*!
+    Returns \c true if the link simulation is enabled; otherwise returns
+    \c false.
+
+    \sa setLinkSimulationEnabled()
+*/
+bool QSerialPortVirtualPair::isLinkSimulationEnabled() const
+{
+    Q_D(const QSerialPortVirtualPair);
+    return d->linkSimulationEnabled;
+}
+
+/*!
+    Enables the link simulation if \a enable is \c true. The default is
+    \c false.
+
+    With the link simulation, each port sends its data at the pace of the
+    baud rate and stop bits currently set on that port, through a transmit
+    queue of 16 characters or 2 milliseconds, whichever is longer. Once the
+    queue is full, the data stays in the driver and in the write buffer of
+    the sending QSerialPort, as with a real line. The receiver gets the
+    characters as they come off the line, delayed and impaired as set with
+    setLinkSimulation().
+
+    \code
+    QSerialPortVirtualPair pair;
+    QSerialPortVirtualPair::LinkSimulation simulation;
+    simulation.latency = 1000;
+    simulation.jitter = 500;
+    pair.setLinkSimulation(simulation);
+    pair.setLinkSimulationEnabled(true);
+    \endcode
+
+    \note Ports with a custom baud rate are not paced. The data bits and
+    parity are taken from the pseudo-terminal, which on Linux always uses
+    8 data bits without parity, whatever a QSerialPort sets. There, the
+    characters take 10 or 11 bit times, and all 8 bits may be flipped.
+
+    \sa isLinkSimulationEnabled(), setLinkSimulation()
+*/
+void QSerialPortVirtualPair::setLinkSimulationEnabled(bool enable)
+{
+    Q_D(QSerialPortVirtualPair);
+
+    d->linkSimulationEnabled = enable;
+#ifdef Q_OS_UNIX
+    if (d->relay)
+        d->relay->setLinkSimulation(enable, d->linkSimulation);
+#endif
+}
+
+/*!
+    Returns the impairments of the simulated line.
+
+    \sa setLinkSimulation()
+*/
+QSerialPortVirtualPair::LinkSimulation QSerialPortVirtualPair::linkSimulation() const
+{
+    Q_D(const QSerialPortVirtualPair);
+    return d->linkSimulation;
+}
+
+/*!
+    Sets the impairments of the simulated line to \a simulation. They
+    apply to the data sent from then on, while the link simulation is
+    enabled. Setting them restarts the random numbers from the seed.
+
+    \sa linkSimulation(), setLinkSimulationEnabled()
+*/
+void QSerialPortVirtualPair::setLinkSimulation(const LinkSimulation &simulation)
+{
+    Q_D(QSerialPortVirtualPair);
+
+    d->linkSimulation = simulation;
+#ifdef Q_OS_UNIX
+    if (d->relay)
+        d->relay->setLinkSimulation(d->linkSimulationEnabled, simulation);
+#endif
+}
+
+QT_END_NAMESPACE
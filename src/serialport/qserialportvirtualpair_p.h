@@ -0,0 +1,171 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtSerialPort module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QSERIALPORTVIRTUALPAIR_P_H
+#define QSERIALPORTVIRTUALPAIR_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qserialportvirtualpair.h"
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qrandom.h>
+#include <QtCore/qthread.h>
+
+#include <private/qobject_p.h>
+
+#ifdef Q_OS_UNIX
+#include <termios.h>
+#endif
+
+QT_BEGIN_NAMESPACE
+
+#ifdef Q_OS_UNIX
+// Copies the data between the master sides of two pseudo-terminals, and
+// mirrors the line settings of one slave side to the other. With the link
+// simulation, the data is delivered at the pace of a real line.
+class QSerialPortVirtualPairRelay : public QThread
+{
+public:
+    QSerialPortVirtualPairRelay(QSerialPortVirtualPair *pair, const int masters[2],
+                                const int slaves[2], const QString portNames[2]);
+    ~QSerialPortVirtualPairRelay();
+
+    bool isValid() const { return wakeUpPipe[0] != -1; }
+
+    void setSettingsMirroringEnabled(bool enable);
+    void setLinkSimulation(bool enable, const QSerialPortVirtualPair::LinkSimulation &simulation);
+
+protected:
+    void run() override;
+
+private:
+    // Data on its way to the receiver. Its bytes arrive one character time
+    // apart, starting at firstArrival.
+    struct WireChunk
+    {
+        QByteArray data;
+        qint64 firstArrival;
+        qint64 characterTime;
+    };
+
+    struct Direction
+    {
+        int from;
+        int to;
+        int sendingSlave;
+        QList<WireChunk> wire;
+        qint64 pendingBytes = 0;
+        // The number of bytes of the first chunk written to the receiver.
+        qint64 delivered = 0;
+        // When the simulated transmitter has sent everything it was given,
+        // and how much it may hold before the sender has to wait.
+        qint64 transmitterFreeAt = 0;
+        qint64 transmitQueueTime = 0;
+        qint64 lastArrival = 0;
+    };
+
+    bool receive(Direction *direction, qint64 now);
+    bool deliver(Direction *direction, qint64 now);
+    static qint64 nextArrival(const Direction &direction);
+    qint64 lineCharacterTime(int slave) const;
+    void corrupt(QByteArray *data, int dataBits);
+    void mirrorSettings();
+    void wakeUp();
+
+    QSerialPortVirtualPair *const pair;
+    int slaves[2];
+    QString portNames[2];
+    Direction directions[2];
+    termios lineSettings[2];
+
+    int wakeUpPipe[2] = { -1, -1 };
+    QAtomicInt stopRequested;
+    QAtomicInt settingsMirroringEnabled;
+
+    QMutex linkSimulationMutex;
+    bool linkSimulationEnabled = false;
+    QSerialPortVirtualPair::LinkSimulation linkSimulation;
+    bool linkSimulationChanged = false;
+
+    // Owned by the relay thread.
+    bool simulating = false;
+    QSerialPortVirtualPair::LinkSimulation simulation;
+    QRandomGenerator random;
+};
+#endif
+
+class QSerialPortVirtualPairPrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(QSerialPortVirtualPair)
+public:
+    QSerialPortVirtualPairPrivate();
+
+    bool createPair();
+    void destroyPair();
+
+    QString portNames[2];
+    QString errorString;
+    bool settingsMirroringEnabled = true;
+    bool linkSimulationEnabled = false;
+    QSerialPortVirtualPair::LinkSimulation linkSimulation;
+
+#ifdef Q_OS_UNIX
+    int masters[2] = { -1, -1 };
+    // The slave sides stay open, so that the masters do not report a
+    // hang-up while no QSerialPort has opened a port of the pair.
+    int slaves[2] = { -1, -1 };
+    QSerialPortVirtualPairRelay *relay = nullptr;
+#endif
+};
+
+QT_END_NAMESPACE
+
+#endif // QSERIALPORTVIRTUALPAIR_P_H
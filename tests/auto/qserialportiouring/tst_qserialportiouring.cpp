@@ -0,0 +1,297 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtSerialPort module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtSerialPort/QSerialPort>
+
+#include <private/qserialport_p.h>
+#include <private/qserialportiouring_p.h>
+
+#include "pseudoterminal.h"
+
+class tst_QSerialPortIoUring : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void read();
+    void largeRead();
+    void write();
+    void blockingReadWrite();
+    void closeWithReadInFlight();
+    void closeWithWriteInFlight();
+    void releaseWithoutEventLoop();
+    void fallback_data();
+    void fallback();
+
+private:
+    static bool usesIoUring(QSerialPort *serialPort)
+    {
+        return QSerialPortPrivate::get(serialPort)->ioUring != nullptr;
+    }
+
+    static QByteArray pattern(qsizetype size)
+    {
+        QByteArray data(size, Qt::Uninitialized);
+        for (qsizetype i = 0; i < size; ++i)
+            data[i] = char('a' + i % 26);
+        return data;
+    }
+
+    static QByteArray readFromTerminal(PseudoTerminal *terminal, qsizetype size)
+    {
+        QByteArray data;
+        char chunk[4096];
+        QDeadlineTimer deadline(5000);
+        while (data.size() < size && !deadline.hasExpired()) {
+            const qint64 readBytes = terminal->read(chunk, sizeof(chunk));
+            if (readBytes > 0)
+                data.append(chunk, readBytes);
+            else
+                QTest::qWait(1);
+        }
+        return data;
+    }
+
+    QByteArray noIoUring;
+};
+
+void tst_QSerialPortIoUring::init()
+{
+    noIoUring = qgetenv("QT_SERIALPORT_NO_IO_URING");
+    qunsetenv("QT_SERIALPORT_NO_IO_URING");
+}
+
+void tst_QSerialPortIoUring::cleanup()
+{
+    if (noIoUring.isNull())
+        qunsetenv("QT_SERIALPORT_NO_IO_URING");
+    else
+        qputenv("QT_SERIALPORT_NO_IO_URING", noIoUring);
+}
+
+#define OPEN_PORT(serialPort, terminal, mode) \
+    PseudoTerminal terminal; \
+    if (!terminal.isValid()) \
+        QSKIP("Cannot create a pseudo-terminal"); \
+    QSerialPort serialPort(terminal.portName()); \
+    QVERIFY(serialPort.open(mode)); \
+    if (!usesIoUring(&serialPort)) \
+        QSKIP("io_uring is not available on this system")
+
+void tst_QSerialPortIoUring::read()
+{
+    OPEN_PORT(serialPort, terminal, QIODevice::ReadOnly);
+
+    QSignalSpy readyReadSpy(&serialPort, &QSerialPort::readyRead);
+    QVERIFY(readyReadSpy.isValid());
+
+    // A read is kept submitted all the time.
+    QVERIFY(QSerialPortPrivate::get(&serialPort)->ioUringReadStarted);
+
+    QCOMPARE(terminal.write("hello", 5), qint64(5));
+    QTRY_COMPARE(serialPort.bytesAvailable(), qint64(5));
+    QVERIFY(readyReadSpy.count() > 0);
+    QCOMPARE(serialPort.readAll(), QByteArray("hello"));
+    QVERIFY(QSerialPortPrivate::get(&serialPort)->ioUringReadStarted);
+}
+
+void tst_QSerialPortIoUring::largeRead()
+{
+    OPEN_PORT(serialPort, terminal, QIODevice::ReadOnly);
+
+    // Large reads hand their array over to the read buffer, small ones are
+    // copied; the data has to come out the same either way.
+    const QByteArray data = pattern(512 * 1024);
+    QByteArray received;
+    qint64 sent = 0;
+    QDeadlineTimer deadline(10000);
+    while (received.size() < data.size() && !deadline.hasExpired()) {
+        if (sent < data.size()) {
+            const qint64 written = terminal.write(data.constData() + sent,
+                                                  qMin<qint64>(data.size() - sent, 8192));
+            QVERIFY(written >= 0);
+            sent += written;
+        }
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+        received += serialPort.readAll();
+    }
+    QCOMPARE(received.size(), data.size());
+    QVERIFY(received == data);
+}
+
+void tst_QSerialPortIoUring::write()
+{
+    OPEN_PORT(serialPort, terminal, QIODevice::WriteOnly);
+
+    QSignalSpy bytesWrittenSpy(&serialPort, &QSerialPort::bytesWritten);
+    QVERIFY(bytesWrittenSpy.isValid());
+
+    const QByteArray data = pattern(64 * 1024);
+    QCOMPARE(serialPort.write(data), qint64(data.size()));
+
+    QByteArray received;
+    QDeadlineTimer deadline(10000);
+    while (received.size() < data.size() && !deadline.hasExpired()) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+        char chunk[4096];
+        qint64 readBytes;
+        while ((readBytes = terminal.read(chunk, sizeof(chunk))) > 0)
+            received.append(chunk, readBytes);
+    }
+    QVERIFY(received == data);
+    QTRY_COMPARE(serialPort.bytesToWrite(), qint64(0));
+
+    qint64 bytesWritten = 0;
+    for (const QList<QVariant> &arguments : qAsConst(bytesWrittenSpy))
+        bytesWritten += arguments.at(0).toLongLong();
+    QCOMPARE(bytesWritten, qint64(data.size()));
+}
+
+void tst_QSerialPortIoUring::blockingReadWrite()
+{
+    OPEN_PORT(serialPort, terminal, QIODevice::ReadWrite);
+
+    QCOMPARE(serialPort.write("ping", 4), qint64(4));
+    QVERIFY(serialPort.waitForBytesWritten(1000));
+    QCOMPARE(readFromTerminal(&terminal, 4), QByteArray("ping"));
+
+    QCOMPARE(terminal.write("pong", 4), qint64(4));
+    QVERIFY(serialPort.waitForReadyRead(1000));
+    while (serialPort.bytesAvailable() < 4 && serialPort.waitForReadyRead(1000)) { }
+    QCOMPARE(serialPort.readAll(), QByteArray("pong"));
+}
+
+void tst_QSerialPortIoUring::closeWithReadInFlight()
+{
+    OPEN_PORT(serialPort, terminal, QIODevice::ReadOnly);
+
+    // Let the read reach the kernel, it waits there for data.
+    QCoreApplication::processEvents();
+    QSerialPortPrivate *d = QSerialPortPrivate::get(&serialPort);
+    QVERIFY(d->ioUringReadStarted);
+    QVERIFY(d->ioUringPendingOperations > 0);
+
+    serialPort.close();
+    QVERIFY(!serialPort.isOpen());
+    QCOMPARE(d->ioUringPendingOperations, 0);
+
+    // The port is usable again after reopening.
+    QVERIFY(serialPort.open(QIODevice::ReadOnly));
+    QCOMPARE(terminal.write("again", 5), qint64(5));
+    QTRY_COMPARE(serialPort.bytesAvailable(), qint64(5));
+    QCOMPARE(serialPort.readAll(), QByteArray("again"));
+}
+
+void tst_QSerialPortIoUring::closeWithWriteInFlight()
+{
+    OPEN_PORT(serialPort, terminal, QIODevice::WriteOnly);
+
+    // Nobody reads the other side, so the write gets stuck as soon as the
+    // buffers of the pseudo-terminal are full.
+    QSerialPortPrivate *d = QSerialPortPrivate::get(&serialPort);
+    QCOMPARE(serialPort.write(pattern(1024 * 1024)), qint64(1024 * 1024));
+    QTRY_VERIFY(d->writeSequenceStarted && d->ioUringPendingOperations > 0);
+    QTest::qWait(50);
+
+    QElapsedTimer timer;
+    timer.start();
+    serialPort.close();
+    QVERIFY(timer.elapsed() < 5000);
+    QVERIFY(!serialPort.isOpen());
+    QCOMPARE(d->ioUringPendingOperations, 0);
+}
+
+void tst_QSerialPortIoUring::releaseWithoutEventLoop()
+{
+    // The ring of a thread without an event loop has to go away with its
+    // last port, deleteLater() would never run there.
+    bool skipped = false;
+    bool deleted = false;
+    QScopedPointer<QThread> thread(QThread::create([&skipped, &deleted]() {
+        PseudoTerminal terminal;
+        QSerialPort serialPort(terminal.portName());
+        if (!terminal.isValid() || !serialPort.open(QIODevice::ReadWrite)
+                || !usesIoUring(&serialPort)) {
+            skipped = true;
+            return;
+        }
+        QPointer<QSerialPortIoUring> ioUring = QSerialPortPrivate::get(&serialPort)->ioUring;
+        serialPort.write("x", 1);
+        serialPort.waitForBytesWritten(1000);
+        serialPort.close();
+        deleted = ioUring.isNull();
+    }));
+    thread->start();
+    QVERIFY(thread->wait(10000));
+    if (skipped)
+        QSKIP("io_uring is not available on this system");
+    QVERIFY(deleted);
+}
+
+void tst_QSerialPortIoUring::fallback_data()
+{
+    QTest::addColumn<bool>("disabled");
+    QTest::addColumn<bool>("readThread");
+
+    QTest::newRow("environment") << true << false;
+    QTest::newRow("readThread") << false << true;
+}
+
+void tst_QSerialPortIoUring::fallback()
+{
+    QFETCH(bool, disabled);
+    QFETCH(bool, readThread);
+
+    if (disabled)
+        qputenv("QT_SERIALPORT_NO_IO_URING", "1");
+
+    PseudoTerminal terminal;
+    if (!terminal.isValid())
+        QSKIP("Cannot create a pseudo-terminal");
+
+    // The readiness based path takes over without any change for the user.
+    QSerialPort serialPort(terminal.portName());
+    serialPort.setReadThreadEnabled(readThread);
+    QVERIFY(serialPort.open(QIODevice::ReadWrite));
+    QVERIFY(!usesIoUring(&serialPort));
+
+    QCOMPARE(terminal.write("in", 2), qint64(2));
+    QTRY_COMPARE(serialPort.bytesAvailable(), qint64(2));
+    QCOMPARE(serialPort.readAll(), QByteArray("in"));
+
+    QCOMPARE(serialPort.write("out", 3), qint64(3));
+    QVERIFY(serialPort.waitForBytesWritten(1000));
+    QCOMPARE(readFromTerminal(&terminal, 3), QByteArray("out"));
+}
+
+QTEST_MAIN(tst_QSerialPortIoUring)
+#include "tst_qserialportiouring.moc"
@@ -0,0 +1,253 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtSerialPort module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtSerialPort/QSerialPort>
+#include <QtSerialPort/QSerialPortModbusMaster>
+
+#include "modbusslavesimulator.h"
+
+Q_DECLARE_METATYPE(QSerialPortModbusMaster::RequestError);
+
+class tst_QSerialPortModbusMaster : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void calculateCrc();
+    void invalidRequests();
+    void pipelinedRequests();
+    void slaveTimeout();
+    void crcError();
+    void exceptionReply();
+    void broadcast();
+
+private:
+    static QByteArray readRegisters(int first, int count);
+};
+
+void tst_QSerialPortModbusMaster::initTestCase()
+{
+    qRegisterMetaType<QSerialPortModbusMaster::RequestError>();
+
+    ModbusSlaveSimulator simulator;
+    if (!simulator.isValid())
+        QSKIP("Cannot create a pseudo-terminal for the simulated slaves");
+}
+
+QByteArray tst_QSerialPortModbusMaster::readRegisters(int first, int count)
+{
+    QByteArray pdu(5, 0);
+    pdu[0] = 0x03;
+    pdu[1] = char(first >> 8);
+    pdu[2] = char(first & 0xff);
+    pdu[3] = char(count >> 8);
+    pdu[4] = char(count & 0xff);
+    return pdu;
+}
+
+void tst_QSerialPortModbusMaster::calculateCrc()
+{
+    // The example frame of the Modbus over serial line specification.
+    const QByteArray frame = QByteArray::fromHex("010300000001");
+    QCOMPARE(QSerialPortModbusMaster::calculateCrc(frame), quint16(0x0a84));
+
+    QByteArray data;
+    for (int i = 0; i < 1024; ++i)
+        data.append(char(i * 7 + 3));
+    QCOMPARE(QSerialPortModbusMaster::calculateCrc(data),
+             ModbusSlaveSimulator::crc(data.constData(), data.size()));
+    QCOMPARE(QSerialPortModbusMaster::calculateCrc(QByteArray()), quint16(0xffff));
+}
+
+void tst_QSerialPortModbusMaster::invalidRequests()
+{
+    QSerialPort serialPort;
+    QSerialPortModbusMaster master(&serialPort);
+    QCOMPARE(master.port(), &serialPort);
+
+    QCOMPARE(master.sendRequest(248, readRegisters(0, 1)), quint64(0));
+    QCOMPARE(master.sendRequest(-1, readRegisters(0, 1)), quint64(0));
+    QCOMPARE(master.sendRequest(1, QByteArray()), quint64(0));
+    QCOMPARE(master.sendRequest(1, QByteArray(254, 0x03)), quint64(0));
+    QCOMPARE(master.pendingRequestCount(), qsizetype(0));
+
+    // The port is not open.
+    QSignalSpy failedSpy(&master, &QSerialPortModbusMaster::requestFailed);
+    const quint64 id = master.sendRequest(1, readRegisters(0, 1));
+    QVERIFY(id != 0);
+    QCOMPARE(master.pendingRequestCount(), qsizetype(1));
+    QTRY_COMPARE(failedSpy.count(), 1);
+    QCOMPARE(failedSpy.at(0).at(0).toULongLong(), id);
+    QCOMPARE(failedSpy.at(0).at(2).value<QSerialPortModbusMaster::RequestError>(),
+             QSerialPortModbusMaster::WriteError);
+    QCOMPARE(master.pendingRequestCount(), qsizetype(0));
+}
+
+void tst_QSerialPortModbusMaster::pipelinedRequests()
+{
+    ModbusSlaveSimulator simulator;
+    const int slaveCount = 16;
+    for (int address = 1; address <= slaveCount; ++address)
+        simulator.addSlave(address);
+
+    QSerialPort serialPort(simulator.portName());
+    QVERIFY(serialPort.open(QIODevice::ReadWrite));
+    QVERIFY(serialPort.setBaudRate(QSerialPort::Baud115200));
+
+    QSerialPortModbusMaster master(&serialPort);
+    QSignalSpy replySpy(&master, &QSerialPortModbusMaster::replyReceived);
+    QSignalSpy failedSpy(&master, &QSerialPortModbusMaster::requestFailed);
+
+    QList<quint64> ids;
+    for (int address = 1; address <= slaveCount; ++address)
+        ids.append(master.sendRequest(address, readRegisters(address, 2)));
+    QCOMPARE(master.pendingRequestCount(), qsizetype(slaveCount));
+
+    QTRY_COMPARE(replySpy.count(), slaveCount);
+    QCOMPARE(failedSpy.count(), 0);
+    QCOMPARE(master.pendingRequestCount(), qsizetype(0));
+
+    // The replies arrive in the order of the requests.
+    for (int i = 0; i < slaveCount; ++i) {
+        const int address = i + 1;
+        QCOMPARE(replySpy.at(i).at(0).toULongLong(), ids.at(i));
+        QCOMPARE(replySpy.at(i).at(1).toInt(), address);
+
+        QByteArray expected;
+        expected.append(char(0x03));
+        expected.append(char(4));
+        for (int registerAddress = address; registerAddress < address + 2; ++registerAddress) {
+            expected.append(char(address));
+            expected.append(char(registerAddress));
+        }
+        QCOMPARE(replySpy.at(i).at(2).toByteArray(), expected);
+    }
+}
+
+void tst_QSerialPortModbusMaster::slaveTimeout()
+{
+    ModbusSlaveSimulator simulator;
+    simulator.addSlave(1);
+
+    QSerialPort serialPort(simulator.portName());
+    QVERIFY(serialPort.open(QIODevice::ReadWrite));
+
+    QSerialPortModbusMaster master(&serialPort);
+    QCOMPARE(master.timeout(), 200);
+    master.setTimeout(5000);
+    master.setSlaveTimeout(5, 20);
+    QCOMPARE(master.slaveTimeout(5), 20);
+    QCOMPARE(master.slaveTimeout(1), 5000);
+
+    QSignalSpy replySpy(&master, &QSerialPortModbusMaster::replyReceived);
+    QSignalSpy failedSpy(&master, &QSerialPortModbusMaster::requestFailed);
+
+    // Slave 5 does not exist, only its own short timeout delays the request
+    // which follows.
+    QElapsedTimer stopWatch;
+    stopWatch.start();
+    const quint64 silentId = master.sendRequest(5, readRegisters(0, 1));
+    const quint64 replyId = master.sendRequest(1, readRegisters(0, 1));
+    QTRY_COMPARE(replySpy.count(), 1);
+    QVERIFY(stopWatch.elapsed() < 2000);
+
+    QCOMPARE(failedSpy.count(), 1);
+    QCOMPARE(failedSpy.at(0).at(0).toULongLong(), silentId);
+    QCOMPARE(failedSpy.at(0).at(1).toInt(), 5);
+    QCOMPARE(failedSpy.at(0).at(2).value<QSerialPortModbusMaster::RequestError>(),
+             QSerialPortModbusMaster::TimeoutError);
+    QCOMPARE(replySpy.at(0).at(0).toULongLong(), replyId);
+
+    master.setSlaveTimeout(5, -1);
+    QCOMPARE(master.slaveTimeout(5), 5000);
+}
+
+void tst_QSerialPortModbusMaster::crcError()
+{
+    ModbusSlaveSimulator simulator;
+    simulator.addSlave(2);
+    simulator.setCrcCorrupted(2, true);
+
+    QSerialPort serialPort(simulator.portName());
+    QVERIFY(serialPort.open(QIODevice::ReadWrite));
+
+    QSerialPortModbusMaster master(&serialPort);
+    QSignalSpy failedSpy(&master, &QSerialPortModbusMaster::requestFailed);
+
+    master.sendRequest(2, readRegisters(0, 1));
+    QTRY_COMPARE(failedSpy.count(), 1);
+    QCOMPARE(failedSpy.at(0).at(2).value<QSerialPortModbusMaster::RequestError>(),
+             QSerialPortModbusMaster::CrcError);
+}
+
+void tst_QSerialPortModbusMaster::exceptionReply()
+{
+    ModbusSlaveSimulator simulator;
+    simulator.addSlave(3);
+
+    QSerialPort serialPort(simulator.portName());
+    QVERIFY(serialPort.open(QIODevice::ReadWrite));
+
+    QSerialPortModbusMaster master(&serialPort);
+    QSignalSpy replySpy(&master, &QSerialPortModbusMaster::replyReceived);
+
+    // Reading input registers is not supported by the simulated slaves.
+    master.sendRequest(3, QByteArray::fromHex("0400000001"));
+    QTRY_COMPARE(replySpy.count(), 1);
+    QCOMPARE(replySpy.at(0).at(2).toByteArray(), QByteArray::fromHex("8401"));
+}
+
+void tst_QSerialPortModbusMaster::broadcast()
+{
+    ModbusSlaveSimulator simulator;
+    simulator.addSlave(1);
+    simulator.addSlave(2);
+
+    QSerialPort serialPort(simulator.portName());
+    QVERIFY(serialPort.open(QIODevice::ReadWrite));
+
+    QSerialPortModbusMaster master(&serialPort);
+    master.setTurnaroundDelay(20);
+    QCOMPARE(master.turnaroundDelay(), 20);
+    QSignalSpy replySpy(&master, &QSerialPortModbusMaster::replyReceived);
+
+    const quint64 broadcastId = master.sendRequest(0, QByteArray::fromHex("0600071234"));
+    master.sendRequest(2, readRegisters(7, 1));
+    QTRY_COMPARE(replySpy.count(), 2);
+
+    QCOMPARE(replySpy.at(0).at(0).toULongLong(), broadcastId);
+    QCOMPARE(replySpy.at(0).at(2).toByteArray(), QByteArray());
+    QCOMPARE(replySpy.at(1).at(2).toByteArray(), QByteArray::fromHex("03021234"));
+    QCOMPARE(simulator.registerValue(1, 7), quint16(0x1234));
+}
+
+QTEST_MAIN(tst_QSerialPortModbusMaster)
+#include "tst_qserialportmodbusmaster.moc"
@@ -0,0 +1,124 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtSerialPort module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <private/qserialport_p.h>
+
+#include <string.h>
+
+class tst_QSerialPortPrivate : public QObject
+{
+    Q_OBJECT
+public:
+    explicit tst_QSerialPortPrivate();
+
+private slots:
+    void cleanup();
+    void findByte_data();
+    void findByte();
+};
+
+tst_QSerialPortPrivate::tst_QSerialPortPrivate()
+{
+}
+
+void tst_QSerialPortPrivate::cleanup()
+{
+    qt_serialport_find_byte_avx2_disabled = false;
+}
+
+void tst_QSerialPortPrivate::findByte_data()
+{
+    QTest::addColumn<bool>("avx2");
+    QTest::addColumn<int>("size");
+    QTest::addColumn<int>("offset");
+
+    // The sizes straddle the 16 and 32 byte vectors, so that every loop
+    // runs with and without a tail left for memchr(). The offsets make
+    // the loads unaligned. On ARM, both rows run the NEON loop.
+    const int sizes[] = { 0, 1, 15, 16, 17, 31, 32, 33, 47, 48, 63, 64, 65, 100, 128, 129 };
+    const int offsets[] = { 0, 1, 7, 15, 31 };
+    for (bool avx2 : { true, false }) {
+        for (int size : sizes) {
+            for (int offset : offsets) {
+                QTest::addRow("%s-%d-%d", avx2 ? "default" : "no-avx2", size, offset)
+                        << avx2 << size << offset;
+            }
+        }
+    }
+}
+
+void tst_QSerialPortPrivate::findByte()
+{
+    QFETCH(bool, avx2);
+    QFETCH(int, size);
+    QFETCH(int, offset);
+
+    if (!avx2)
+        qt_serialport_find_byte_avx2_disabled = true;
+
+    // Matches right before and after the searched range must not count.
+    QByteArray storage(offset + size + 64, 'x');
+    char *data = storage.data() + offset;
+    const char needle = '\n';
+    storage[storage.size() - 1] = needle;
+    if (offset > 0)
+        data[-1] = needle;
+    data[size] = needle;
+
+    const auto expected = [&]() -> qsizetype {
+        const void *match = ::memchr(data, needle, size_t(size));
+        return match ? static_cast<const char *>(match) - data : -1;
+    };
+
+    QCOMPARE(qt_serialport_find_byte(data, size, needle), qsizetype(-1));
+    QCOMPARE(expected(), qsizetype(-1));
+
+    for (int position = 0; position < size; ++position) {
+        data[position] = needle;
+        QCOMPARE(qt_serialport_find_byte(data, size, needle), expected());
+        QCOMPARE(qt_serialport_find_byte(data, size, needle), qsizetype(position));
+
+        // A second match further on must not hide the first one.
+        if (position + 1 < size) {
+            data[size - 1] = needle;
+            QCOMPARE(qt_serialport_find_byte(data, size, needle), qsizetype(position));
+            data[size - 1] = 'x';
+        }
+        data[position] = 'x';
+    }
+
+    // Bytes with the top bit set compare as negative chars.
+    data[size / 2] = char(0xff);
+    QCOMPARE(qt_serialport_find_byte(data, size, char(0xff)),
+             size ? qsizetype(size / 2) : qsizetype(-1));
+}
+
+QTEST_MAIN(tst_QSerialPortPrivate)
+#include "tst_qserialportprivate.moc"
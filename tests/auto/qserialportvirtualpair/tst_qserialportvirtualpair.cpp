@@ -0,0 +1,322 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtSerialPort module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtSerialPort/QSerialPort>
+#include <QtSerialPort/QSerialPortVirtualPair>
+
+#include <termios.h>
+
+class tst_QSerialPortVirtualPair : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void transfer();
+    void largeTransfer();
+    void settingsMirroring();
+    void settingsMirroringDisabled();
+    void settingsMirroringFrameFormat();
+    void linkSimulationPacing();
+    void linkSimulationErrors();
+
+private:
+    static speed_t outputSpeed(const QSerialPort &port);
+    static tcflag_t controlFlags(const QSerialPort &port);
+    static QByteArray transfer(QSerialPortVirtualPair *pair, const QByteArray &data);
+};
+
+void tst_QSerialPortVirtualPair::initTestCase()
+{
+    if (!QSerialPortVirtualPair::isSupported())
+        QSKIP("Virtual serial port pairs are not supported on this platform");
+}
+
+speed_t tst_QSerialPortVirtualPair::outputSpeed(const QSerialPort &port)
+{
+    termios tio;
+    if (::tcgetattr(port.handle(), &tio) == -1)
+        return 0;
+    return ::cfgetospeed(&tio);
+}
+
+tcflag_t tst_QSerialPortVirtualPair::controlFlags(const QSerialPort &port)
+{
+    termios tio;
+    if (::tcgetattr(port.handle(), &tio) == -1)
+        return 0;
+    return tio.c_cflag;
+}
+
+void tst_QSerialPortVirtualPair::transfer()
+{
+    QSerialPortVirtualPair pair;
+    QVERIFY2(pair.isValid(), qPrintable(pair.errorString()));
+    QVERIFY(!pair.firstPortName().isEmpty());
+    QVERIFY(!pair.secondPortName().isEmpty());
+    QVERIFY(pair.firstPortName() != pair.secondPortName());
+
+    QSerialPort first(pair.firstPortName());
+    QCOMPARE(first.portName(), pair.firstPortName());
+    QVERIFY(first.open(QIODevice::ReadWrite));
+    QSerialPort second(pair.secondPortName());
+    QCOMPARE(second.portName(), pair.secondPortName());
+    QVERIFY(second.open(QIODevice::ReadWrite));
+
+    const QByteArray request("ping");
+    QCOMPARE(first.write(request), qint64(request.size()));
+    while (second.bytesAvailable() < request.size())
+        QVERIFY(second.waitForReadyRead(1000));
+    QCOMPARE(second.readAll(), request);
+
+    const QByteArray reply("pong");
+    QCOMPARE(second.write(reply), qint64(reply.size()));
+    while (first.bytesAvailable() < reply.size())
+        QVERIFY(first.waitForReadyRead(1000));
+    QCOMPARE(first.readAll(), reply);
+}
+
+void tst_QSerialPortVirtualPair::largeTransfer()
+{
+    QSerialPortVirtualPair pair;
+    QVERIFY2(pair.isValid(), qPrintable(pair.errorString()));
+
+    QSerialPort sender(pair.firstPortName());
+    QVERIFY(sender.open(QIODevice::WriteOnly));
+    QSerialPort receiver(pair.secondPortName());
+    QVERIFY(receiver.open(QIODevice::ReadOnly));
+
+    // More than the pseudo-terminals buffer, so the relay has to wait for
+    // the receiver.
+    QByteArray data(1024 * 1024, Qt::Uninitialized);
+    for (int i = 0; i < data.size(); ++i)
+        data[i] = char(i * 7);
+
+    QByteArray received;
+    connect(&receiver, &QSerialPort::readyRead, this, [&receiver, &received]() {
+        received += receiver.readAll();
+    });
+
+    QCOMPARE(sender.write(data), qint64(data.size()));
+    QTRY_COMPARE_WITH_TIMEOUT(received.size(), data.size(), 10000);
+    QCOMPARE(received, data);
+}
+
+void tst_QSerialPortVirtualPair::settingsMirroring()
+{
+    QSerialPortVirtualPair pair;
+    QVERIFY2(pair.isValid(), qPrintable(pair.errorString()));
+    QVERIFY(pair.isSettingsMirroringEnabled());
+
+    QSerialPort first(pair.firstPortName());
+    QVERIFY(first.open(QIODevice::ReadWrite));
+    QSerialPort second(pair.secondPortName());
+    QVERIFY(second.open(QIODevice::ReadWrite));
+
+    // Opening a port applies its settings, let these settle first.
+    QSignalSpy mirroredSpy(&pair, &QSerialPortVirtualPair::settingsMirrored);
+    QVERIFY(mirroredSpy.isValid());
+    QTest::qWait(100);
+    mirroredSpy.clear();
+
+    QVERIFY(first.setBaudRate(QSerialPort::Baud115200));
+    QTRY_COMPARE(outputSpeed(second), speed_t(B115200));
+    QTRY_VERIFY(!mirroredSpy.isEmpty());
+    QCOMPARE(mirroredSpy.first().at(0).toString(), pair.firstPortName());
+    QCOMPARE(mirroredSpy.first().at(1).toString(), pair.secondPortName());
+
+    mirroredSpy.clear();
+    QVERIFY(second.setBaudRate(QSerialPort::Baud4800));
+    QTRY_COMPARE(outputSpeed(first), speed_t(B4800));
+    QTRY_VERIFY(!mirroredSpy.isEmpty());
+    QCOMPARE(mirroredSpy.first().at(0).toString(), pair.secondPortName());
+    QCOMPARE(mirroredSpy.first().at(1).toString(), pair.firstPortName());
+}
+
+void tst_QSerialPortVirtualPair::settingsMirroringDisabled()
+{
+    QSerialPortVirtualPair pair;
+    QVERIFY2(pair.isValid(), qPrintable(pair.errorString()));
+    pair.setSettingsMirroringEnabled(false);
+    QVERIFY(!pair.isSettingsMirroringEnabled());
+
+    QSerialPort first(pair.firstPortName());
+    QVERIFY(first.open(QIODevice::ReadWrite));
+    QSerialPort second(pair.secondPortName());
+    QVERIFY(second.open(QIODevice::ReadWrite));
+
+    QSignalSpy mirroredSpy(&pair, &QSerialPortVirtualPair::settingsMirrored);
+    QVERIFY(mirroredSpy.isValid());
+
+    QVERIFY(first.setBaudRate(QSerialPort::Baud115200));
+    QTest::qWait(100);
+    QCOMPARE(outputSpeed(second), speed_t(B9600));
+    QVERIFY(mirroredSpy.isEmpty());
+}
+
+void tst_QSerialPortVirtualPair::settingsMirroringFrameFormat()
+{
+    QSerialPortVirtualPair pair;
+    QVERIFY2(pair.isValid(), qPrintable(pair.errorString()));
+
+    QSerialPort first(pair.firstPortName());
+    QVERIFY(first.open(QIODevice::ReadWrite));
+    QSerialPort second(pair.secondPortName());
+    QVERIFY(second.open(QIODevice::ReadWrite));
+
+    QSignalSpy mirroredSpy(&pair, &QSerialPortVirtualPair::settingsMirrored);
+    QVERIFY(mirroredSpy.isValid());
+    QTest::qWait(100);
+    mirroredSpy.clear();
+
+    QVERIFY(first.setStopBits(QSerialPort::TwoStop));
+    QTRY_VERIFY(controlFlags(second) & CSTOPB);
+    QTRY_VERIFY(!mirroredSpy.isEmpty());
+
+    mirroredSpy.clear();
+    QVERIFY(first.setDataBits(QSerialPort::Data7));
+    QVERIFY(first.setParity(QSerialPort::EvenParity));
+    QCOMPARE(first.dataBits(), QSerialPort::Data7);
+    QCOMPARE(first.parity(), QSerialPort::EvenParity);
+#ifdef Q_OS_LINUX
+    // The pseudo-terminal drops both, so there is nothing to mirror.
+    QTest::qWait(100);
+    QCOMPARE(controlFlags(first) & (CSIZE | PARENB), tcflag_t(CS8));
+    QCOMPARE(controlFlags(second) & (CSIZE | PARENB), tcflag_t(CS8));
+    QVERIFY(mirroredSpy.isEmpty());
+#else
+    QTRY_COMPARE(controlFlags(second) & (CSIZE | PARENB), tcflag_t(CS7 | PARENB));
+    QVERIFY(!mirroredSpy.isEmpty());
+#endif
+}
+
+QByteArray tst_QSerialPortVirtualPair::transfer(QSerialPortVirtualPair *pair,
+                                                const QByteArray &data)
+{
+    QSerialPort sender(pair->firstPortName());
+    sender.setBaudRate(QSerialPort::Baud115200);
+    if (!sender.open(QIODevice::WriteOnly))
+        return QByteArray();
+    QSerialPort receiver(pair->secondPortName());
+    receiver.setBaudRate(QSerialPort::Baud115200);
+    if (!receiver.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    sender.write(data);
+    sender.waitForBytesWritten(1000);
+
+    // Lost characters never arrive, so wait until the line is quiet.
+    QByteArray received;
+    while (receiver.waitForReadyRead(200))
+        received += receiver.readAll();
+    return received;
+}
+
+void tst_QSerialPortVirtualPair::linkSimulationPacing()
+{
+    QSerialPortVirtualPair pair;
+    QVERIFY2(pair.isValid(), qPrintable(pair.errorString()));
+    pair.setSettingsMirroringEnabled(false);
+    QVERIFY(!pair.isLinkSimulationEnabled());
+    pair.setLinkSimulationEnabled(true);
+    QVERIFY(pair.isLinkSimulationEnabled());
+
+    QSerialPort sender(pair.firstPortName());
+    QVERIFY(sender.open(QIODevice::WriteOnly));
+    QVERIFY(sender.setBaudRate(QSerialPort::Baud9600));
+    QSerialPort receiver(pair.secondPortName());
+    QVERIFY(receiver.open(QIODevice::ReadOnly));
+
+    // 10 bits per character take about 100 ms at 9600 baud.
+    const QByteArray data(96, 'x');
+    QElapsedTimer timer;
+    timer.start();
+    QCOMPARE(sender.write(data), qint64(data.size()));
+
+    QByteArray received;
+    while (received.size() < data.size()) {
+        QVERIFY(receiver.waitForReadyRead(1000));
+        received += receiver.readAll();
+    }
+    QVERIFY2(timer.elapsed() >= 90, QByteArray::number(timer.elapsed()));
+    QCOMPARE(received, data);
+}
+
+void tst_QSerialPortVirtualPair::linkSimulationErrors()
+{
+    QByteArray data(1000, Qt::Uninitialized);
+    for (int i = 0; i < data.size(); ++i)
+        data[i] = char(i);
+
+    QSerialPortVirtualPair::LinkSimulation simulation;
+    simulation.bitErrorRate = 0.01;
+    simulation.seed = 42;
+
+    QByteArray corrupted;
+    {
+        QSerialPortVirtualPair pair;
+        QVERIFY2(pair.isValid(), qPrintable(pair.errorString()));
+        pair.setSettingsMirroringEnabled(false);
+        pair.setLinkSimulation(simulation);
+        pair.setLinkSimulationEnabled(true);
+        QCOMPARE(pair.linkSimulation().seed, quint32(42));
+
+        corrupted = transfer(&pair, data);
+        QCOMPARE(corrupted.size(), data.size());
+        QVERIFY(corrupted != data);
+    }
+
+    {
+        // The same seed corrupts the same characters.
+        QSerialPortVirtualPair pair;
+        QVERIFY2(pair.isValid(), qPrintable(pair.errorString()));
+        pair.setSettingsMirroringEnabled(false);
+        pair.setLinkSimulation(simulation);
+        pair.setLinkSimulationEnabled(true);
+        QCOMPARE(transfer(&pair, data), corrupted);
+    }
+
+    {
+        QSerialPortVirtualPair pair;
+        QVERIFY2(pair.isValid(), qPrintable(pair.errorString()));
+        pair.setSettingsMirroringEnabled(false);
+        simulation.bitErrorRate = 0;
+        simulation.overrunRate = 0.1;
+        pair.setLinkSimulation(simulation);
+        pair.setLinkSimulationEnabled(true);
+
+        const QByteArray received = transfer(&pair, data);
+        QVERIFY(received.size() < data.size());
+        QVERIFY(received.size() > data.size() / 2);
+    }
+}
+
+QTEST_MAIN(tst_QSerialPortVirtualPair)
+#include "tst_qserialportvirtualpair.moc"
@@ -0,0 +1,598 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtSerialPort module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtSerialPort/QSerialPort>
+#include <QtSerialPort/QSerialPortGroup>
+#include <QtSerialPort/QSerialPortInfo>
+#include <QtSerialPort/QSerialPortVirtualPair>
+
+#ifdef QT_BUILD_INTERNAL
+#include <QtSerialPort/private/qserialport_p.h>
+#endif
+
+#include <memory>
+#include <vector>
+
+#include "pseudoterminal.h"
+
+Q_DECLARE_METATYPE(QSerialPort::ReadChunkPolicy);
+Q_DECLARE_METATYPE(QSerialPort::WritePolicy);
+Q_DECLARE_METATYPE(QSerialPort::LockingStrategy);
+
+class tst_QSerialPort_Bench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void readChunkPolicy_data();
+    void readChunkPolicy();
+    void portGroup_data();
+    void portGroup();
+    void ioUringBatching_data();
+    void ioUringBatching();
+    void blockingReceive_data();
+    void blockingReceive();
+    void canReadLine_data();
+    void canReadLine();
+    void readNotification_data();
+    void readNotification();
+    void writeData_data();
+    void writeData();
+    void openClose_data();
+    void openClose();
+    void lockFilePath_data();
+    void lockFilePath();
+    void settingFromBaudRate_data();
+    void settingFromBaudRate();
+    void availablePorts();
+    void simulatedLink_data();
+    void simulatedLink();
+};
+
+void tst_QSerialPort_Bench::readChunkPolicy_data()
+{
+    QTest::addColumn<QSerialPort::ReadChunkPolicy>("policy");
+    QTest::addColumn<qint32>("baudRate");
+    QTest::addColumn<int>("burstSize");
+
+    // A slow port trickles a few bytes per notification, a fast one
+    // delivers whatever the driver managed to queue in the meantime.
+    QTest::newRow("Fixed-9600") << QSerialPort::FixedReadChunk << 9600 << 8;
+    QTest::newRow("Available-9600") << QSerialPort::AvailableReadChunk << 9600 << 8;
+    QTest::newRow("Adaptive-9600") << QSerialPort::AdaptiveReadChunk << 9600 << 8;
+    QTest::newRow("Fixed-3000000") << QSerialPort::FixedReadChunk << 3000000 << 65536;
+    QTest::newRow("Available-3000000") << QSerialPort::AvailableReadChunk << 3000000 << 65536;
+    QTest::newRow("Adaptive-3000000") << QSerialPort::AdaptiveReadChunk << 3000000 << 65536;
+}
+
+void tst_QSerialPort_Bench::readChunkPolicy()
+{
+    QFETCH(QSerialPort::ReadChunkPolicy, policy);
+    QFETCH(qint32, baudRate);
+    QFETCH(int, burstSize);
+
+    PseudoTerminal terminal;
+    if (!terminal.isValid())
+        QSKIP("Cannot create a pseudo-terminal");
+
+    QSerialPort serialPort(terminal.portName());
+    serialPort.setReadChunkPolicy(policy);
+    QVERIFY(serialPort.open(QIODevice::ReadOnly));
+    // Pseudo-terminals accept any standard speed, only the adaptive
+    // policy looks at it.
+    serialPort.setBaudRate(baudRate);
+
+    const qint64 totalSize = 256 * 1024;
+    const QByteArray burst(burstSize, 'x');
+
+    QBENCHMARK {
+        qint64 sentBytes = 0;
+        qint64 receivedBytes = 0;
+        while (receivedBytes < totalSize) {
+            if (sentBytes < totalSize) {
+                const qint64 written = terminal.write(burst.constData(),
+                                                      qMin(qint64(burst.size()), totalSize - sentBytes));
+                QVERIFY(written >= 0);
+                sentBytes += written;
+            }
+            QVERIFY(serialPort.waitForReadyRead(1000));
+            receivedBytes += serialPort.readAll().size();
+        }
+    }
+}
+
+void tst_QSerialPort_Bench::portGroup_data()
+{
+    QTest::addColumn<bool>("grouped");
+    QTest::addColumn<int>("portCount");
+
+    // Run with -tickcounter or -callgrind to compare the CPU time spent
+    // per byte rather than the wall time.
+    QTest::newRow("independent-16") << false << 16;
+    QTest::newRow("group-16") << true << 16;
+    QTest::newRow("independent-128") << false << 128;
+    QTest::newRow("group-128") << true << 128;
+}
+
+void tst_QSerialPort_Bench::portGroup()
+{
+    QFETCH(bool, grouped);
+    QFETCH(int, portCount);
+
+    if (grouped && !QSerialPortGroup::isSupported())
+        QSKIP("Serial port groups are not supported on this platform");
+
+    std::vector<std::unique_ptr<PseudoTerminal>> terminals;
+    std::vector<std::unique_ptr<QSerialPort>> serialPorts;
+    QSerialPortGroup group;
+    qint64 receivedBytes = 0;
+
+    for (int i = 0; i < portCount; ++i) {
+        auto terminal = std::make_unique<PseudoTerminal>();
+        if (!terminal->isValid())
+            QSKIP("Cannot create enough pseudo-terminals");
+
+        auto serialPort = std::make_unique<QSerialPort>(terminal->portName());
+        QSerialPort *port = serialPort.get();
+        connect(port, &QSerialPort::readyRead, this, [port, &receivedBytes]() {
+            receivedBytes += port->readAll().size();
+        });
+        if (grouped)
+            QVERIFY(group.addPort(port));
+        QVERIFY(port->open(QIODevice::ReadOnly));
+
+        terminals.push_back(std::move(terminal));
+        serialPorts.push_back(std::move(serialPort));
+    }
+
+    // Each round sends a short message to every port, as a poll cycle of
+    // a field bus master would.
+    const QByteArray message(64, 'x');
+    const qint64 roundSize = qint64(message.size()) * portCount;
+
+    QBENCHMARK {
+        receivedBytes = 0;
+        for (const auto &terminal : terminals)
+            QCOMPARE(terminal->write(message.constData(), message.size()), qint64(message.size()));
+
+        QDeadlineTimer deadline(5000);
+        while (receivedBytes < roundSize && !deadline.hasExpired())
+            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents, 100);
+        QCOMPARE(receivedBytes, roundSize);
+    }
+}
+
+void tst_QSerialPort_Bench::ioUringBatching_data()
+{
+    QTest::addColumn<bool>("ioUring");
+    QTest::addColumn<int>("portCount");
+
+    // The io_uring rows share one ring per thread, so a poll cycle costs a
+    // single io_uring_enter() for all ports instead of one read() each.
+    // Where io_uring is not available, both rows measure readiness.
+    QTest::newRow("readiness-16") << false << 16;
+    QTest::newRow("io_uring-16") << true << 16;
+    QTest::newRow("readiness-128") << false << 128;
+    QTest::newRow("io_uring-128") << true << 128;
+}
+
+void tst_QSerialPort_Bench::ioUringBatching()
+{
+#ifndef Q_OS_LINUX
+    QSKIP("io_uring is only available on Linux");
+#else
+    QFETCH(bool, ioUring);
+    QFETCH(int, portCount);
+
+    // The backend is chosen when a port is opened.
+    const QByteArray noIoUring = qgetenv("QT_SERIALPORT_NO_IO_URING");
+    if (ioUring)
+        qunsetenv("QT_SERIALPORT_NO_IO_URING");
+    else
+        qputenv("QT_SERIALPORT_NO_IO_URING", "1");
+
+    std::vector<std::unique_ptr<PseudoTerminal>> terminals;
+    std::vector<std::unique_ptr<QSerialPort>> serialPorts;
+    qint64 receivedBytes = 0;
+    bool opened = true;
+
+    for (int i = 0; i < portCount && opened; ++i) {
+        auto terminal = std::make_unique<PseudoTerminal>();
+        if (!terminal->isValid())
+            break;
+
+        auto serialPort = std::make_unique<QSerialPort>(terminal->portName());
+        QSerialPort *port = serialPort.get();
+        connect(port, &QSerialPort::readyRead, this, [port, &receivedBytes]() {
+            receivedBytes += port->readAll().size();
+        });
+        opened = port->open(QIODevice::ReadOnly);
+
+        terminals.push_back(std::move(terminal));
+        serialPorts.push_back(std::move(serialPort));
+    }
+
+    if (noIoUring.isNull())
+        qunsetenv("QT_SERIALPORT_NO_IO_URING");
+    else
+        qputenv("QT_SERIALPORT_NO_IO_URING", noIoUring);
+
+    if (int(serialPorts.size()) < portCount)
+        QSKIP("Cannot create enough pseudo-terminals");
+    QVERIFY(opened);
+
+    const QByteArray message(64, 'x');
+    const qint64 roundSize = qint64(message.size()) * portCount;
+
+    QBENCHMARK {
+        receivedBytes = 0;
+        for (const auto &terminal : terminals)
+            QCOMPARE(terminal->write(message.constData(), message.size()), qint64(message.size()));
+
+        QDeadlineTimer deadline(5000);
+        while (receivedBytes < roundSize && !deadline.hasExpired())
+            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents, 100);
+        QCOMPARE(receivedBytes, roundSize);
+    }
+#endif
+}
+
+void tst_QSerialPort_Bench::blockingReceive_data()
+{
+    QTest::addColumn<int>("messageSize");
+    QTest::addColumn<int>("messageCount");
+
+    // Run under strace -c to compare the system calls spent per wakeup
+    // of a blocking receiver thread.
+    QTest::newRow("small-messages") << 16 << 64;
+    QTest::newRow("large-messages") << 1024 << 16;
+}
+
+void tst_QSerialPort_Bench::blockingReceive()
+{
+    QFETCH(int, messageSize);
+    QFETCH(int, messageCount);
+
+    PseudoTerminal terminal;
+    if (!terminal.isValid())
+        QSKIP("Cannot create a pseudo-terminal");
+
+    QSerialPort serialPort(terminal.portName());
+    QVERIFY(serialPort.open(QIODevice::ReadOnly));
+
+    // Several messages are queued by the driver before the receiver wakes
+    // up, as with a worker that is busy processing the previous batch.
+    const QByteArray message(messageSize, 'x');
+    const qint64 batchSize = qint64(messageSize) * messageCount;
+
+    QBENCHMARK {
+        for (int i = 0; i < messageCount; ++i)
+            QCOMPARE(terminal.write(message.constData(), message.size()), qint64(message.size()));
+
+        qint64 receivedBytes = 0;
+        while (receivedBytes < batchSize) {
+            QVERIFY(serialPort.waitForReadyRead(1000));
+            receivedBytes += serialPort.readAll().size();
+        }
+        QCOMPARE(receivedBytes, batchSize);
+    }
+}
+
+void tst_QSerialPort_Bench::canReadLine_data()
+{
+    QTest::addColumn<int>("lineLength");
+
+    // A long line trickling in as small pieces is the worst case for a
+    // search from the beginning of the buffer on every piece.
+    QTest::newRow("line-80") << 80;
+    QTest::newRow("line-16384") << 16384;
+    QTest::newRow("line-65536") << 65536;
+}
+
+void tst_QSerialPort_Bench::canReadLine()
+{
+    QFETCH(int, lineLength);
+
+    PseudoTerminal terminal;
+    if (!terminal.isValid())
+        QSKIP("Cannot create a pseudo-terminal");
+
+    QSerialPort serialPort(terminal.portName());
+    serialPort.setLineTerminator("\r\n");
+    QVERIFY(serialPort.open(QIODevice::ReadOnly));
+
+    const QByteArray piece(16, 'x');
+    const QByteArray line = QByteArray(lineLength, 'x') + "\r\n";
+
+    QBENCHMARK {
+        qint64 sentBytes = 0;
+        while (!serialPort.canReadTerminatedLine()) {
+            if (sentBytes < line.size()) {
+                const qint64 size = qMin(qint64(piece.size()), line.size() - sentBytes);
+                QCOMPARE(terminal.write(line.constData() + sentBytes, size), size);
+                sentBytes += size;
+            }
+            QVERIFY(serialPort.waitForReadyRead(1000));
+        }
+        QCOMPARE(serialPort.readTerminatedLine(), line);
+    }
+}
+
+void tst_QSerialPort_Bench::readNotification_data()
+{
+    QTest::addColumn<int>("chunkSize");
+
+    // Each chunk is picked up by its own read notification, unless the
+    // driver has queued more by the time the event loop gets to it.
+    QTest::newRow("chunk-1") << 1;
+    QTest::newRow("chunk-64") << 64;
+    QTest::newRow("chunk-4096") << 4096;
+}
+
+void tst_QSerialPort_Bench::readNotification()
+{
+    QFETCH(int, chunkSize);
+
+    PseudoTerminal terminal;
+    if (!terminal.isValid())
+        QSKIP("Cannot create a pseudo-terminal");
+
+    QSerialPort serialPort(terminal.portName());
+    qint64 receivedBytes = 0;
+    connect(&serialPort, &QSerialPort::readyRead, this, [&serialPort, &receivedBytes]() {
+        receivedBytes += serialPort.readAll().size();
+    });
+    QVERIFY(serialPort.open(QIODevice::ReadOnly));
+
+    const qint64 totalSize = 64 * 1024;
+    const QByteArray chunk(chunkSize, 'x');
+
+    QBENCHMARK {
+        receivedBytes = 0;
+        qint64 sentBytes = 0;
+        QDeadlineTimer deadline(10000);
+        while (receivedBytes < totalSize && !deadline.hasExpired()) {
+            if (sentBytes < totalSize) {
+                const qint64 written = terminal.write(chunk.constData(),
+                                                      qMin(qint64(chunk.size()), totalSize - sentBytes));
+                QVERIFY(written >= 0);
+                sentBytes += written;
+            }
+            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents, 100);
+        }
+        QCOMPARE(receivedBytes, totalSize);
+    }
+}
+
+void tst_QSerialPort_Bench::writeData_data()
+{
+    QTest::addColumn<int>("chunkSize");
+    QTest::addColumn<QSerialPort::WritePolicy>("policy");
+
+    // Small writes show the fixed cost of every write() call on the port.
+    QTest::newRow("chunk-1-immediate") << 1 << QSerialPort::ImmediateWrite;
+    QTest::newRow("chunk-1-deferred") << 1 << QSerialPort::DeferredWrite;
+    QTest::newRow("chunk-16-immediate") << 16 << QSerialPort::ImmediateWrite;
+    QTest::newRow("chunk-16-deferred") << 16 << QSerialPort::DeferredWrite;
+    QTest::newRow("chunk-1024-immediate") << 1024 << QSerialPort::ImmediateWrite;
+    QTest::newRow("chunk-1024-deferred") << 1024 << QSerialPort::DeferredWrite;
+}
+
+void tst_QSerialPort_Bench::writeData()
+{
+    QFETCH(int, chunkSize);
+    QFETCH(QSerialPort::WritePolicy, policy);
+
+    PseudoTerminal terminal;
+    if (!terminal.isValid())
+        QSKIP("Cannot create a pseudo-terminal");
+
+    QSerialPort serialPort(terminal.portName());
+    serialPort.setWritePolicy(policy);
+    QVERIFY(serialPort.open(QIODevice::WriteOnly));
+
+    // Small enough to fit into the pseudo-terminal, so that the port never
+    // waits for the reader.
+    const qint64 batchSize = 4096;
+    const QByteArray chunk(chunkSize, 'x');
+    QByteArray sink(batchSize, Qt::Uninitialized);
+
+    QBENCHMARK {
+        for (qint64 sentBytes = 0; sentBytes < batchSize; sentBytes += chunkSize)
+            QCOMPARE(serialPort.write(chunk), qint64(chunkSize));
+        while (serialPort.bytesToWrite() > 0)
+            QVERIFY(serialPort.waitForBytesWritten(1000));
+
+        qint64 drainedBytes = 0;
+        QDeadlineTimer deadline(1000);
+        while (drainedBytes < batchSize && !deadline.hasExpired())
+            drainedBytes += terminal.read(sink.data(), sink.size());
+        QCOMPARE(drainedBytes, batchSize);
+    }
+}
+
+void tst_QSerialPort_Bench::openClose_data()
+{
+    QTest::addColumn<qint32>("baudRate");
+    QTest::addColumn<QSerialPort::LockingStrategy>("strategy");
+
+    // A standard baud rate is set together with the line settings, a
+    // custom one takes requests of its own.
+    QTest::newRow("115200-LockFile") << 115200 << QSerialPort::LockFileLocking;
+    QTest::newRow("250000-LockFile") << 250000 << QSerialPort::LockFileLocking;
+    QTest::newRow("115200-Descriptor") << 115200 << QSerialPort::DescriptorLocking;
+    QTest::newRow("115200-ExclusiveMode") << 115200 << QSerialPort::ExclusiveModeLocking;
+    QTest::newRow("115200-None") << 115200 << QSerialPort::NoLocking;
+}
+
+void tst_QSerialPort_Bench::openClose()
+{
+    QFETCH(qint32, baudRate);
+    QFETCH(QSerialPort::LockingStrategy, strategy);
+
+    PseudoTerminal terminal;
+    if (!terminal.isValid())
+        QSKIP("Cannot create a pseudo-terminal");
+
+    // Includes taking the lock file and configuring the port.
+    QSerialPort serialPort(terminal.portName());
+    QVERIFY(serialPort.setBaudRate(baudRate));
+    serialPort.setLockingStrategy(strategy);
+    if (!serialPort.open(QIODevice::ReadWrite))
+        QSKIP("The pseudo-terminal does not take this baud rate");
+    serialPort.close();
+
+    QBENCHMARK {
+        QVERIFY(serialPort.open(QIODevice::ReadWrite));
+        serialPort.close();
+    }
+}
+
+void tst_QSerialPort_Bench::lockFilePath_data()
+{
+    QTest::addColumn<bool>("cached");
+
+    // Without the cache, every lookup probes the candidate directories.
+    QTest::newRow("cached") << true;
+    QTest::newRow("uncached") << false;
+}
+
+void tst_QSerialPort_Bench::lockFilePath()
+{
+#ifdef QT_BUILD_INTERNAL
+    QFETCH(bool, cached);
+
+    const QString portName = QSerialPortInfo(QStringLiteral("/dev/ttyS0")).portName();
+    QString lockFilePath;
+    QBENCHMARK {
+        if (!cached)
+            invalidateSerialPortLockDirectory();
+        lockFilePath = serialPortLockFilePath(portName);
+    }
+    QVERIFY(!lockFilePath.isEmpty());
+#else
+    QSKIP("This benchmark requires a developer build");
+#endif
+}
+
+void tst_QSerialPort_Bench::settingFromBaudRate_data()
+{
+    QTest::addColumn<qint32>("baudRate");
+
+    QTest::newRow("9600") << 9600;
+    QTest::newRow("115200") << 115200;
+    QTest::newRow("3000000") << 3000000;
+    // A custom rate is not in the table and misses the lookup.
+    QTest::newRow("250000") << 250000;
+}
+
+void tst_QSerialPort_Bench::settingFromBaudRate()
+{
+#ifdef QT_BUILD_INTERNAL
+    QFETCH(qint32, baudRate);
+
+    qint32 setting = 0;
+    QBENCHMARK {
+        setting = QSerialPortPrivate::settingFromBaudRate(baudRate);
+    }
+    Q_UNUSED(setting);
+#else
+    QSKIP("This benchmark requires a developer build");
+#endif
+}
+
+void tst_QSerialPort_Bench::availablePorts()
+{
+    QList<QSerialPortInfo> ports;
+    QBENCHMARK {
+        ports = QSerialPortInfo::availablePorts();
+    }
+}
+
+void tst_QSerialPort_Bench::simulatedLink_data()
+{
+    QTest::addColumn<qint32>("baudRate");
+    QTest::addColumn<int>("messageSize");
+    QTest::addColumn<int>("latency");
+
+    // The wall time is dominated by the simulated line. Compare the CPU
+    // time with -tickcounter or -callgrind, and the statistics of the
+    // ports, to see how the pipeline copes with a real pace.
+    QTest::newRow("9600-16") << 9600 << 16 << 0;
+    QTest::newRow("115200-16") << 115200 << 16 << 0;
+    QTest::newRow("115200-256") << 115200 << 256 << 0;
+    QTest::newRow("115200-256-usb") << 115200 << 256 << 1000;
+}
+
+void tst_QSerialPort_Bench::simulatedLink()
+{
+    QFETCH(qint32, baudRate);
+    QFETCH(int, messageSize);
+    QFETCH(int, latency);
+
+    QSerialPortVirtualPair pair;
+    if (!pair.isValid())
+        QSKIP("Cannot create a virtual serial port pair");
+
+    QSerialPortVirtualPair::LinkSimulation simulation;
+    simulation.latency = latency;
+    pair.setLinkSimulation(simulation);
+    pair.setLinkSimulationEnabled(true);
+
+    QSerialPort sender(pair.firstPortName());
+    sender.setBaudRate(baudRate);
+    QVERIFY(sender.open(QIODevice::WriteOnly));
+    QSerialPort receiver(pair.secondPortName());
+    receiver.setBaudRate(baudRate);
+    QVERIFY(receiver.open(QIODevice::ReadOnly));
+
+    qint64 receivedBytes = 0;
+    connect(&receiver, &QSerialPort::readyRead, this, [&receiver, &receivedBytes]() {
+        receivedBytes += receiver.readAll().size();
+    });
+
+    // About 100 ms of line time per iteration.
+    const QByteArray message(messageSize, 'x');
+    const int messageCount = qMax(1, baudRate / 100 / messageSize);
+    const qint64 totalSize = qint64(messageSize) * messageCount;
+
+    QBENCHMARK {
+        receivedBytes = 0;
+        for (int i = 0; i < messageCount; ++i)
+            QCOMPARE(sender.write(message), qint64(message.size()));
+
+        QDeadlineTimer deadline(5000);
+        while (receivedBytes < totalSize && !deadline.hasExpired())
+            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents, 100);
+        QCOMPARE(receivedBytes, totalSize);
+    }
+}
+
+QTEST_MAIN(tst_QSerialPort_Bench)
+#include "tst_bench_qserialport.moc"
@@ -0,0 +1,168 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtSerialPort module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef MODBUSSLAVESIMULATOR_H
+#define MODBUSSLAVESIMULATOR_H
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qset.h>
+#include <QtCore/qsocketnotifier.h>
+
+#include "pseudoterminal.h"
+
+// Modbus RTU slaves behind a pseudo-terminal. The port under test opens
+// portName() and acts as the master of the simulated bus.
+//
+// The slaves support reading holding registers (0x03) and writing a single
+// register (0x06); other functions get an "illegal function" exception.
+// Registers which were never written hold their slave address in the high
+// byte and their register address in the low byte.
+class ModbusSlaveSimulator : public QObject
+{
+public:
+    ModbusSlaveSimulator()
+    {
+        if (!terminal.isValid())
+            return;
+        notifier = new QSocketNotifier(terminal.descriptor(), QSocketNotifier::Read, this);
+        connect(notifier, &QSocketNotifier::activated, this, [this]() { receive(); });
+    }
+
+    bool isValid() const { return terminal.isValid(); }
+    QString portName() const { return terminal.portName(); }
+
+    void addSlave(int address) { slaves.insert(address); }
+    void setCrcCorrupted(int address, bool corrupted)
+    {
+        if (corrupted)
+            corruptedSlaves.insert(address);
+        else
+            corruptedSlaves.remove(address);
+    }
+
+    quint16 registerValue(int address, int registerAddress) const
+    {
+        return registers.value(registerKey(address, registerAddress),
+                               quint16((address << 8) | (registerAddress & 0xff)));
+    }
+
+    int requestCount() const { return receivedRequests; }
+
+    // A plain bitwise implementation, to check the one under test.
+    static quint16 crc(const char *data, qsizetype size)
+    {
+        quint16 crc = 0xffff;
+        for (qsizetype i = 0; i < size; ++i) {
+            crc ^= uchar(data[i]);
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc & 1) ? quint16((crc >> 1) ^ 0xa001) : quint16(crc >> 1);
+        }
+        return crc;
+    }
+
+private:
+    static int registerKey(int address, int registerAddress)
+    {
+        return (address << 16) | registerAddress;
+    }
+
+    void receive()
+    {
+        char data[256];
+        qint64 readBytes;
+        while ((readBytes = terminal.read(data, sizeof(data))) > 0)
+            buffer.append(data, readBytes);
+
+        // All supported requests are eight bytes long.
+        while (buffer.size() >= 8) {
+            const QByteArray request = buffer.left(8);
+            buffer.remove(0, 8);
+            process(request);
+        }
+    }
+
+    void process(const QByteArray &request)
+    {
+        const quint16 requestCrc = quint16(uchar(request.at(6)) | (uchar(request.at(7)) << 8));
+        if (requestCrc != crc(request.constData(), 6))
+            return;
+        ++receivedRequests;
+
+        const int address = uchar(request.at(0));
+        const int function = uchar(request.at(1));
+        const int first = (uchar(request.at(2)) << 8) | uchar(request.at(3));
+        const int value = (uchar(request.at(4)) << 8) | uchar(request.at(5));
+
+        if (address == 0) {
+            if (function == 0x06) {
+                for (int slave : qAsConst(slaves))
+                    registers.insert(registerKey(slave, first), quint16(value));
+            }
+            return;
+        }
+        if (!slaves.contains(address))
+            return;
+
+        QByteArray reply;
+        reply.append(char(address));
+        if (function == 0x03) {
+            reply.append(char(function));
+            reply.append(char(value * 2));
+            for (int i = 0; i < value; ++i) {
+                const quint16 registerContent = registerValue(address, first + i);
+                reply.append(char(registerContent >> 8));
+                reply.append(char(registerContent & 0xff));
+            }
+        } else if (function == 0x06) {
+            registers.insert(registerKey(address, first), quint16(value));
+            reply = request.left(6);
+        } else {
+            reply.append(char(function | 0x80));
+            reply.append(char(0x01));
+        }
+
+        quint16 replyCrc = crc(reply.constData(), reply.size());
+        if (corruptedSlaves.contains(address))
+            replyCrc ^= 0x5555;
+        reply.append(char(replyCrc & 0xff));
+        reply.append(char(replyCrc >> 8));
+        terminal.write(reply.constData(), reply.size());
+    }
+
+    PseudoTerminal terminal;
+    QSocketNotifier *notifier = nullptr;
+    QByteArray buffer;
+    QSet<int> slaves;
+    QSet<int> corruptedSlaves;
+    QHash<int, quint16> registers;
+    int receivedRequests = 0;
+};
+
+#endif // MODBUSSLAVESIMULATOR_H
@@ -0,0 +1,105 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtSerialPort module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef PSEUDOTERMINAL_H
+#define PSEUDOTERMINAL_H
+
+#include <QtCore/qstring.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Master side of a pseudo-terminal. The slave side is a tty device which
+// QSerialPort opens by name, so tests and benchmarks can run without real
+// hardware.
+class PseudoTerminal
+{
+public:
+    PseudoTerminal()
+    {
+        masterDescriptor = ::posix_openpt(O_RDWR | O_NOCTTY);
+        if (masterDescriptor == -1)
+            return;
+
+        const char *name = nullptr;
+        if (::grantpt(masterDescriptor) == -1 || ::unlockpt(masterDescriptor) == -1
+                || (name = ::ptsname(masterDescriptor)) == nullptr) {
+            ::close(masterDescriptor);
+            masterDescriptor = -1;
+            return;
+        }
+
+        slaveName = QString::fromLocal8Bit(name);
+        ::fcntl(masterDescriptor, F_SETFL, ::fcntl(masterDescriptor, F_GETFL) | O_NONBLOCK);
+
+        // Keep the slave side open, otherwise the master reports a hang-up
+        // each time the port under test is closed.
+        slaveDescriptor = ::open(name, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    }
+
+    ~PseudoTerminal()
+    {
+        if (slaveDescriptor != -1)
+            ::close(slaveDescriptor);
+        if (masterDescriptor != -1)
+            ::close(masterDescriptor);
+    }
+
+    bool isValid() const { return masterDescriptor != -1 && slaveDescriptor != -1; }
+    QString portName() const { return slaveName; }
+    int descriptor() const { return masterDescriptor; }
+
+    qint64 write(const char *data, qint64 size)
+    {
+        qint64 written;
+        do {
+            written = ::write(masterDescriptor, data, size_t(size));
+        } while (written == -1 && errno == EINTR);
+        return (written == -1 && errno == EAGAIN) ? 0 : written;
+    }
+
+    qint64 read(char *data, qint64 size)
+    {
+        qint64 readBytes;
+        do {
+            readBytes = ::read(masterDescriptor, data, size_t(size));
+        } while (readBytes == -1 && errno == EINTR);
+        return (readBytes == -1 && errno == EAGAIN) ? 0 : readBytes;
+    }
+
+private:
+    Q_DISABLE_COPY(PseudoTerminal)
+
+    int masterDescriptor = -1;
+    int slaveDescriptor = -1;
+    QString slaveName;
+};
+
+#endif // PSEUDOTERMINAL_H